@@ -12,6 +12,18 @@
 #include <string.h>
 #include <assert.h>
 
+#ifdef BIGINT_THREADS
+#include <pthread.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BIGINT_POSIX
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 typedef struct {
     bool is_negative;
     int64_t *digits;
@@ -20,6 +32,160 @@ typedef struct {
 
 void bigint_delete(bigint n);
 
+/* Algorithm crossover thresholds
+* Every switch between algorithm tiers reads its threshold from
+* bigint_thresholds at runtime. The defaults come from the macros below,
+* which a header written by tools/tune.c can set when BIGINT_THRESHOLDS_HEADER
+* names it, and bigint_thresholds_load reads the same header at runtime.
+*/
+#ifdef BIGINT_THRESHOLDS_HEADER
+#include BIGINT_THRESHOLDS_HEADER
+#endif
+
+// Below this many limbs, Karatsuba falls back to the schoolbook method
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD 32
+#endif
+#if BIGINT_KARATSUBA_THRESHOLD < 4
+#error "BIGINT_KARATSUBA_THRESHOLD must be at least 4"
+#endif
+
+// Above this many limbs in the smaller operand, products use NTTs
+#ifndef BIGINT_NTT_THRESHOLD
+#define BIGINT_NTT_THRESHOLD 3000
+#endif
+
+// Above this many digits in both the divisor and the quotient, division uses Newton's method
+#ifndef BIGINT_NEWTON_DIV_THRESHOLD
+#define BIGINT_NEWTON_DIV_THRESHOLD 300
+#endif
+
+// Above this many quotient digits, divexact multiplies by a 10-adic inverse
+#ifndef BIGINT_DIVEXACT_DC_THRESHOLD
+#define BIGINT_DIVEXACT_DC_THRESHOLD 400
+#endif
+
+// The number of bases at which bigint_multi_pow switches to buckets
+#ifndef BIGINT_PIPPENGER_THRESHOLD
+#define BIGINT_PIPPENGER_THRESHOLD 32
+#endif
+
+// Above this many digits, conversions to 32-bit words divide and conquer
+#ifndef BIGINT_TO_WORDS_DC_THRESHOLD
+#define BIGINT_TO_WORDS_DC_THRESHOLD 300000
+#endif
+
+// Above this many digits, conversions from 32-bit words divide and conquer
+#ifndef BIGINT_FROM_WORDS_DC_THRESHOLD
+#define BIGINT_FROM_WORDS_DC_THRESHOLD 8000
+#endif
+
+typedef struct {
+    size_t karatsuba;
+    size_t ntt;
+    size_t newton_div;
+    size_t divexact_dc;
+    size_t pippenger;
+    size_t to_words_dc;
+    size_t from_words_dc;
+} bigint_threshold_table;
+
+// The thresholds in use, which should only change before other threads start; karatsuba must be at least 4
+bigint_threshold_table bigint_thresholds = {
+    BIGINT_KARATSUBA_THRESHOLD,
+    BIGINT_NTT_THRESHOLD,
+    BIGINT_NEWTON_DIV_THRESHOLD,
+    BIGINT_DIVEXACT_DC_THRESHOLD,
+    BIGINT_PIPPENGER_THRESHOLD,
+    BIGINT_TO_WORDS_DC_THRESHOLD,
+    BIGINT_FROM_WORDS_DC_THRESHOLD,
+};
+
+// The macro name and smallest safe value of each threshold, for reading and writing headers
+typedef struct {
+    const char *name;
+    size_t *value;
+    size_t minimum;
+} bigint_threshold_entry;
+
+// Karatsuba's middle product is as large as its input below 4 limbs, so it would never reach the base case
+bigint_threshold_entry bigint_threshold_entries[] = {
+    {"BIGINT_KARATSUBA_THRESHOLD", &bigint_thresholds.karatsuba, 4},
+    {"BIGINT_NTT_THRESHOLD", &bigint_thresholds.ntt, 1},
+    {"BIGINT_NEWTON_DIV_THRESHOLD", &bigint_thresholds.newton_div, 1},
+    {"BIGINT_DIVEXACT_DC_THRESHOLD", &bigint_thresholds.divexact_dc, 1},
+    {"BIGINT_PIPPENGER_THRESHOLD", &bigint_thresholds.pippenger, 1},
+    {"BIGINT_TO_WORDS_DC_THRESHOLD", &bigint_thresholds.to_words_dc, 1},
+    {"BIGINT_FROM_WORDS_DC_THRESHOLD", &bigint_thresholds.from_words_dc, 1},
+};
+
+#define BIGINT_THRESHOLD_COUNT (sizeof(bigint_threshold_entries) / sizeof(bigint_threshold_entries[0]))
+
+/* Write the thresholds in use as a header of #define lines
+* @param file The file to write to
+* @return Whether every write succeeded
+*/
+bool bigint_thresholds_write(FILE *file) {
+    bool ok = fprintf(file, "// Algorithm thresholds for bigint.h\n") >= 0;
+    for (size_t i = 0; ok && i < BIGINT_THRESHOLD_COUNT; i++) {
+        ok = fprintf(file, "#define %s %zu\n", bigint_threshold_entries[i].name, *bigint_threshold_entries[i].value) >= 0;
+    }
+    return ok;
+}
+
+/* Load thresholds from a header written by bigint_thresholds_write
+* Lines other than #define lines for known thresholds are ignored, and
+* thresholds the file does not mention keep their values. Values below a
+* threshold's minimum are rejected and leave it unchanged.
+* @param path The header to read
+* @return Whether the file could be read and every value was accepted
+*/
+bool bigint_thresholds_load(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    char line[256], name[128];
+    unsigned long long value;
+    bool accepted = true;
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, " #define %127s %llu", name, &value) != 2) {
+            continue;
+        }
+        for (size_t i = 0; i < BIGINT_THRESHOLD_COUNT; i++) {
+            if (strcmp(name, bigint_threshold_entries[i].name) != 0) {
+                continue;
+            }
+            if (value < bigint_threshold_entries[i].minimum) {
+                accepted = false;
+            } else {
+                *bigint_threshold_entries[i].value = (size_t)value;
+            }
+        }
+    }
+    bool ok = !ferror(file) && accepted;
+    fclose(file);
+    return ok;
+}
+
+/* Declare a read-only bigint constant with static storage
+* The digits are listed most significant first, so
+* BIGINT_CONSTANT(p, false, 1, 0, 0, 0, 0, 0, 3) declares p = 1000003.
+* A constant is built without parsing or allocation and can be shared
+* between threads, but it must never be freed or modified in place.
+* tools/bigint_constgen.c emits these declarations from decimal literals.
+* @param name The name of the constant
+* @param negative Whether the constant is negative
+* @param ... The decimal digits, without leading zeros
+*/
+#define BIGINT_CONSTANT(name, negative, ...) \
+    static const int64_t name##_digits[] = {__VA_ARGS__}; \
+    static const bigint name = {negative, (int64_t *)name##_digits, sizeof(name##_digits) / sizeof(int64_t)}
+
+// Constants for read-only operands inside the library
+BIGINT_CONSTANT(bigint_const_zero, false, 0);
+BIGINT_CONSTANT(bigint_const_one, false, 1);
+
 bigint bigint_zero() {
     bigint result;
     result.is_negative = false;
@@ -72,6 +238,15 @@ void bigint_remove_leading_zeros(bigint *n) {
     }
 }
 
+// n without its leading zeros, sharing its digits and leaving them untouched
+bigint bigint_trimmed(bigint n) {
+    while (n.size > 1 && n.digits[0] == 0) {
+        n.digits++;
+        n.size--;
+    }
+    return n;
+}
+
 bigint bigint_from_int(int64_t n) {
     bigint result;
     if (n < 0) {
@@ -108,32 +283,81 @@ int64_t bigint_to_int(bigint n) {
     return result;
 }
 
-/* Create a new bigint from an integer 
-* @param n The integer to create a bigint from
-* @return A new bigint with the value of n
+// Whether a character is ASCII whitespace
+bool bigint_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Whether all 8 bytes of a word are ASCII digits: each high nibble is 3,
+// and adding 6 keeps it 3, which rules out ':' through '?'
+bool bigint_swar_digits(uint64_t word) {
+    const uint64_t high = 0xF0F0F0F0F0F0F0F0ULL, threes = 0x3030303030303030ULL;
+    return (word & high) == threes && ((word + 0x0606060606060606ULL) & high) == threes;
+}
+
+/* Parse a decimal string with validation
+* Accepts optional surrounding whitespace, an optional '+' or '-' sign and
+* at least one digit. Digits are validated eight at a time with word-wide
+* (SWAR) checks, and leading zeros are dropped.
+* @param s The characters to parse, which need not be NUL-terminated
+* @param length The number of characters
+* @param out Set to a new bigint on success, and left untouched otherwise
+* @return Whether the string was a valid decimal integer
 */
-bigint bigint_from_string(const char *n) {
-    bigint result;
-    
-    // Determine if the number is negative
-    if (n[0] == '-') {
-        result.is_negative = true;
-        n++;
-    } else {
-        result.is_negative = false;
+bool bigint_parse(const char *s, size_t length, bigint *out) {
+    const char *end = s + length;
+    while (s < end && bigint_is_space(*s)) {
+        s++;
+    }
+    while (end > s && bigint_is_space(end[-1])) {
+        end--;
+    }
+    bool negative = false;
+    if (s < end && (*s == '+' || *s == '-')) {
+        negative = *s == '-';
+        s++;
+    }
+    if (s == end) {
+        return false;
     }
 
-    // Determine the size of the number
-    result.size = strlen(n);
+    size_t size = end - s, i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, s + i, sizeof(word));
+        if (!bigint_swar_digits(word)) {
+            return false;
+        }
+    }
+    for (; i < size; i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return false;
+        }
+    }
 
-    // Allocate memory for the digits
-    result.digits = malloc(result.size * sizeof(int64_t));
-    
-    // Copy the digits into the bigint
-    for (size_t i = 0; i < result.size; i++) {
-        result.digits[i] = n[i] - '0';
+    while (size > 1 && *s == '0') {
+        s++;
+        size--;
+    }
+    out->is_negative = negative && *s != '0';
+    out->size = size;
+    out->digits = malloc(size * sizeof(int64_t));
+    for (i = 0; i < size; i++) {
+        out->digits[i] = s[i] - '0';
+    }
+    return true;
+}
+
+/* Create a new bigint from a decimal string
+* @param n A NUL-terminated string accepted by bigint_parse
+* @return A new bigint with the value of n
+*/
+bigint bigint_from_string(const char *n) {
+    bigint result;
+    if (!bigint_parse(n, strlen(n), &result)) {
+        assert(!"bigint_from_string: invalid decimal string");
+        return bigint_zero();
     }
-    
     return result;
 }
 
@@ -147,23 +371,365 @@ bigint bigint_copy(bigint n) {
     return result;
 }
 
+/* A read-only view of digits owned by something else
+* Views never allocate or free, so a view must not outlive the digits it
+* points into. bigint_from_view turns a view into a borrowed bigint that
+* every read-only function accepts.
+*/
+typedef struct {
+    bool is_negative;
+    const int64_t *digits;
+    size_t size;
+} bigint_view;
+
+/* View all of a bigint's digits
+* @param n The bigint
+* @return A view sharing n's digits
+*/
+bigint_view bigint_view_of(bigint n) {
+    bigint_view view = {n.is_negative, n.digits, n.size};
+    return view;
+}
+
+/* View a range of place values of a view
+* For a split point k, the slices [k, size) and [0, k) are the quotient and
+* remainder of |v| by 10^k, each with v's sign, without copying any digits.
+* @param v The view to slice
+* @param low The lowest place value in the slice
+* @param count The number of place values, clamped to the digits of v
+* @return A view of floor(|v| / 10^low) mod 10^count with v's sign, possibly with leading zeros
+*/
+bigint_view bigint_view_slice(bigint_view v, size_t low, size_t count) {
+    if (low >= v.size || count == 0) {
+        return bigint_view_of(bigint_const_zero);
+    }
+    size_t available = v.size - low;
+    if (count > available) {
+        count = available;
+    }
+    bigint_view slice = {v.is_negative, v.digits + (available - count), count};
+    return slice;
+}
+
+/* Borrow a view as a bigint for read-only use
+* @param v The view
+* @return A bigint sharing the view's digits, which must not be freed or modified in place
+*/
+bigint bigint_from_view(bigint_view v) {
+    bigint n = {v.is_negative, (int64_t *)v.digits, v.size};
+    return n;
+}
+
+/* Swap two bigints without touching their digits
+* @param a The first bigint
+* @param b The second bigint
+*/
+void bigint_swap(bigint *a, bigint *b) {
+    bigint tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BIGINT_ATOMIC_ADD(p, v) __atomic_add_fetch(p, v, __ATOMIC_ACQ_REL)
+#define BIGINT_ATOMIC_LOAD(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define BIGINT_ATOMIC_STORE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#else
+// Without compiler atomics, handles must not be shared across threads
+#define BIGINT_ATOMIC_ADD(p, v) (*(p) += (v))
+#define BIGINT_ATOMIC_LOAD(p) (*(p))
+#define BIGINT_ATOMIC_STORE(p, v) (*(p) = (v))
+#endif
+
+// A reference-counted bigint shared by any number of handles
+typedef struct {
+    bigint value;
+    long refcount;
+} bigint_shared;
+
+/* A copy-on-write handle to a shared bigint
+* Copying and swapping handles is O(1), and handles may be copied, read
+* and deleted from several threads at once without locking.
+*/
+typedef struct {
+    bigint_shared *shared;
+} bigint_ref;
+
+/* Create a handle that owns a bigint
+* @param n The bigint to take ownership of
+* @return A new handle, to be freed with bigint_ref_delete
+*/
+bigint_ref bigint_ref_new(bigint n) {
+    bigint_ref ref;
+    ref.shared = malloc(sizeof(bigint_shared));
+    ref.shared->value = n;
+    ref.shared->refcount = 1;
+    return ref;
+}
+
+/* Copy a handle without copying its digits
+* @param ref The handle to copy
+* @return A new handle to the same value
+*/
+bigint_ref bigint_ref_copy(bigint_ref ref) {
+    BIGINT_ATOMIC_ADD(&ref.shared->refcount, 1);
+    return ref;
+}
+
+/* Read the value behind a handle
+* @param ref The handle to read
+* @return The shared value, which must not be modified or deleted
+*/
+bigint bigint_ref_get(bigint_ref ref) {
+    return ref.shared->value;
+}
+
+/* Delete a handle, freeing the value when it was the last one
+* @param ref The handle to delete
+*/
+void bigint_ref_delete(bigint_ref ref) {
+    if (BIGINT_ATOMIC_ADD(&ref.shared->refcount, -1) == 0) {
+        bigint_delete(ref.shared->value);
+        free(ref.shared);
+    }
+}
+
+/* Get a modifiable value, copying it first if other handles share it
+* @param ref The handle to detach
+* @return A pointer to a value owned only by this handle
+*/
+bigint *bigint_ref_mut(bigint_ref *ref) {
+    if (BIGINT_ATOMIC_LOAD(&ref->shared->refcount) > 1) {
+        bigint_ref detached = bigint_ref_new(bigint_copy(ref->shared->value));
+        bigint_ref_delete(*ref);
+        *ref = detached;
+    }
+    return &ref->shared->value;
+}
+
+/* Swap two handles
+* @param a The first handle
+* @param b The second handle
+*/
+void bigint_ref_swap(bigint_ref *a, bigint_ref *b) {
+    bigint_ref tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+// The size of the text buffer used by streaming reads and writes
+#ifndef BIGINT_STREAM_BUFFER
+#define BIGINT_STREAM_BUFFER 65536
+#endif
+
+/* Reads the next chunk of a stream
+* @param context The reader's state
+* @param buffer The buffer to fill
+* @param size The size of the buffer
+* @param count Set to the number of characters read, or 0 at the end of the stream
+* @return Whether the read succeeded
+*/
+typedef bool (*bigint_read_fn)(void *context, char *buffer, size_t size, size_t *count);
+
+/* Writes a chunk of a stream
+* @param context The writer's state
+* @param buffer The characters to write
+* @param size The number of characters
+* @return Whether the write succeeded
+*/
+typedef bool (*bigint_write_fn)(void *context, const char *buffer, size_t size);
+
+/* Read a decimal bigint from a stream, one chunk at a time
+* The whole stream is consumed and must hold one integer in the format
+* accepted by bigint_parse. Only the digits and one text buffer are held
+* in memory, never the whole text.
+* @param read The reader
+* @param context The reader's state
+* @param n Set to a new bigint on success, and left untouched otherwise
+* @return Whether the stream was read and held a valid integer
+*/
+bool bigint_read_stream(bigint_read_fn read, void *context, bigint *n) {
+    enum {LEADING, SIGN, ZEROS, DIGITS, TRAILING} state = LEADING;
+    char *buffer = malloc(BIGINT_STREAM_BUFFER);
+    size_t size = 0, capacity = 0;
+    int64_t *digits = NULL;
+    bool negative = false, ok = true;
+    while (ok) {
+        size_t count;
+        if (!read(context, buffer, BIGINT_STREAM_BUFFER, &count)) {
+            ok = false;
+            break;
+        }
+        if (count == 0) {
+            break;
+        }
+        for (size_t i = 0; ok && i < count;) {
+            char c = buffer[i];
+            if (state == LEADING && bigint_is_space(c)) {
+                i++;
+            } else if (state == LEADING && (c == '+' || c == '-')) {
+                negative = c == '-';
+                state = SIGN;
+                i++;
+            } else if (state <= ZEROS && c == '0') {
+                state = ZEROS;
+                i++;
+            } else if (state <= DIGITS && c >= '0' && c <= '9') {
+                // Find the run of digits, eight at a time where possible
+                size_t end = i;
+                uint64_t word;
+                while (end + 8 <= count && (memcpy(&word, buffer + end, sizeof(word)), bigint_swar_digits(word))) {
+                    end += 8;
+                }
+                while (end < count && buffer[end] >= '0' && buffer[end] <= '9') {
+                    end++;
+                }
+                if (size + (end - i) > capacity) {
+                    capacity = capacity * 2 > size + (end - i) ? capacity * 2 : size + (end - i);
+                    digits = realloc(digits, capacity * sizeof(int64_t));
+                }
+                for (; i < end; i++) {
+                    digits[size++] = buffer[i] - '0';
+                }
+                state = DIGITS;
+            } else if ((state == ZEROS || state == DIGITS || state == TRAILING) && bigint_is_space(c)) {
+                state = TRAILING;
+                i++;
+            } else {
+                ok = false;
+            }
+        }
+    }
+    free(buffer);
+
+    if (!ok || state < ZEROS) {
+        free(digits);
+        return false;
+    }
+    if (size == 0) {
+        free(digits);
+        *n = bigint_zero();
+        return true;
+    }
+    n->is_negative = negative;
+    n->size = size;
+    n->digits = size < capacity ? realloc(digits, size * sizeof(int64_t)) : digits;
+    return true;
+}
+
+/* Write a bigint in decimal to a stream, one buffer at a time
+* @param n The bigint to write
+* @param write The writer
+* @param context The writer's state
+* @return Whether every write succeeded
+*/
+bool bigint_write_stream(bigint n, bigint_write_fn write, void *context) {
+    size_t start = 0;
+    while (start < n.size - 1 && n.digits[start] == 0) {
+        start++;
+    }
+    if (n.is_negative && !write(context, "-", 1)) {
+        return false;
+    }
+    size_t chunk = n.size - start < BIGINT_STREAM_BUFFER ? n.size - start : BIGINT_STREAM_BUFFER;
+    char *buffer = malloc(chunk);
+    bool ok = true;
+    for (size_t i = start; ok && i < n.size; i += chunk) {
+        size_t count = n.size - i < chunk ? n.size - i : chunk;
+        for (size_t j = 0; j < count; j++) {
+            assert(n.digits[i + j] >= 0 && n.digits[i + j] <= 9);
+            buffer[j] = (char)('0' + n.digits[i + j]);
+        }
+        ok = write(context, buffer, count);
+    }
+    free(buffer);
+    return ok;
+}
+
+// Reader and writer callbacks for a FILE *
+bool bigint_file_read(void *context, char *buffer, size_t size, size_t *count) {
+    *count = fread(buffer, 1, size, context);
+    return *count > 0 || !ferror((FILE *)context);
+}
+
+bool bigint_file_write(void *context, const char *buffer, size_t size) {
+    return fwrite(buffer, 1, size, context) == size;
+}
+
+/* Read a decimal bigint from the rest of a file
+* @param file The file to read to its end
+* @param n Set to a new bigint on success
+* @return Whether the file held a valid integer
+*/
+bool bigint_fread(FILE *file, bigint *n) {
+    return bigint_read_stream(bigint_file_read, file, n);
+}
+
+/* Write a bigint in decimal to a file
+* @param file The file to write to
+* @param n The bigint to write
+* @return Whether every write succeeded
+*/
+bool bigint_fwrite(FILE *file, bigint n) {
+    return bigint_write_stream(n, bigint_file_write, file);
+}
+
+#ifdef BIGINT_POSIX
+// Reader and writer callbacks for a file descriptor, retrying interrupted calls
+bool bigint_fd_read(void *context, char *buffer, size_t size, size_t *count) {
+    ssize_t result;
+    do {
+        result = read(*(int *)context, buffer, size);
+    } while (result < 0 && errno == EINTR);
+    *count = result > 0 ? (size_t)result : 0;
+    return result >= 0;
+}
+
+bool bigint_fd_write(void *context, const char *buffer, size_t size) {
+    while (size > 0) {
+        ssize_t result = write(*(int *)context, buffer, size);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        buffer += result;
+        size -= (size_t)result;
+    }
+    return true;
+}
+
+/* Read a decimal bigint from the rest of a file descriptor
+* @param fd The file descriptor to read to its end
+* @param n Set to a new bigint on success
+* @return Whether the descriptor held a valid integer
+*/
+bool bigint_fdread(int fd, bigint *n) {
+    return bigint_read_stream(bigint_fd_read, &fd, n);
+}
+
+/* Write a bigint in decimal to a file descriptor
+* @param fd The file descriptor to write to
+* @param n The bigint to write
+* @return Whether every write succeeded
+*/
+bool bigint_fdwrite(int fd, bigint n) {
+    return bigint_write_stream(n, bigint_fd_write, &fd);
+}
+#endif
+
 /* Print a bigint
 * @param n The bigint to print
 */
 void bigint_print(bigint n) {
-    if (n.is_negative) {
-        printf("-");
-    }
-    for (size_t i = 0; i < n.size; i++) {
-        assert(n.digits[i] >= 0 && n.digits[i] <= 9);
-        printf("%lld", n.digits[i]);
-    }
+    bigint_fwrite(stdout, n);
 }
 
 
 bool bigint_gt(bigint a, bigint b) {
-    bigint_remove_leading_zeros(&a);
-    bigint_remove_leading_zeros(&b);
+    a = bigint_trimmed(a);
+    b = bigint_trimmed(b);
     if (a.size > b.size) {
         return !a.is_negative;
     }
@@ -182,8 +748,8 @@ bool bigint_gt(bigint a, bigint b) {
 }
 
 bool bigint_eq(bigint a, bigint b) {
-    bigint_remove_leading_zeros(&a);
-    bigint_remove_leading_zeros(&b);
+    a = bigint_trimmed(a);
+    b = bigint_trimmed(b);
     if (a.size != b.size) {
         return false;
     }
@@ -199,7 +765,7 @@ bool bigint_eq(bigint a, bigint b) {
 }
 
 bool bigint_eqzero(bigint n) {
-    bigint_remove_leading_zeros(&n);
+    n = bigint_trimmed(n);
     if (n.size == 1 && n.digits[0] == 0) {
         return true;
     }
@@ -207,14 +773,14 @@ bool bigint_eqzero(bigint n) {
 }
 
 bool bigint_ltzero(bigint n) {
-    bigint_remove_leading_zeros(&n);
+    n = bigint_trimmed(n);
     if (n.size == 1 && n.digits[0] == 0) {
         return false;
     }
     return n.is_negative;
 }
 bool bigint_gtzero(bigint n) {
-    bigint_remove_leading_zeros(&n);
+    n = bigint_trimmed(n);
     if (n.size == 1 && n.digits[0] == 0) {
         return false;
     }
@@ -222,7 +788,7 @@ bool bigint_gtzero(bigint n) {
 }
 
 bool bigint_lezero(bigint n) {
-    bigint_remove_leading_zeros(&n);
+    n = bigint_trimmed(n);
     if (n.size == 1 && n.digits[0] == 0) {
         return true;
     }
@@ -230,13 +796,17 @@ bool bigint_lezero(bigint n) {
 }
 
 bool bigint_gezero(bigint n) {
-    bigint_remove_leading_zeros(&n);
+    n = bigint_trimmed(n);
     if (n.size == 1 && n.digits[0] == 0) {
         return true;
     }
     return !n.is_negative;
 }
 
+/* The absolute value of a bigint, borrowed rather than copied
+* @param n The bigint
+* @return A bigint sharing n's digits, which must not be freed separately from n
+*/
 bigint bigint_abs(bigint n) {
     n.is_negative = false;
     return n;
@@ -254,6 +824,164 @@ bool bigint_le(bigint a, bigint b) {
     return !bigint_gt(a, b);
 }
 
+// The multipliers of the hash, from wyhash
+#define BIGINT_HASH_P0 0xa0761d6478bd642fULL
+#define BIGINT_HASH_P1 0xe7037ed1a0b428dbULL
+#define BIGINT_HASH_P2 0x8ebc6af09c88c6e3ULL
+
+// Fold the 128-bit product of two words into one
+uint64_t bigint_hash_mix(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t product = (__uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+    uint64_t a_high = a >> 32, a_low = (uint32_t)a, b_high = b >> 32, b_low = (uint32_t)b;
+    uint64_t high = a_high * b_high, middle1 = a_high * b_low, middle2 = a_low * b_high, low = a_low * b_low;
+    uint64_t carry = ((low >> 32) + (uint32_t)middle1 + (uint32_t)middle2) >> 32;
+    low += (middle1 << 32) + (middle2 << 32);
+    high += (middle1 >> 32) + (middle2 >> 32) + carry;
+    return low ^ high;
+#endif
+}
+
+// Pack up to 16 decimal digits into the nibbles of a word
+uint64_t bigint_hash_pack(const int64_t *digits, size_t count) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < count; i++) {
+        word = word << 4 | (uint64_t)digits[i];
+    }
+    return word;
+}
+
+/* Hash the value of a bigint
+* Equal values hash equally, whatever their leading zeros or the sign of
+* zero. Digits are packed 16 to a word and mixed two words at a time with
+* wide multiplications, in the style of wyhash. The result depends only on
+* the value and the seed, so it is stable across processes and platforms.
+* @param n The bigint to hash
+* @param seed The seed
+* @return The 64-bit hash
+*/
+uint64_t bigint_hash(bigint n, uint64_t seed) {
+    n = bigint_trimmed(n);
+    const int64_t *digits = n.digits;
+    size_t size = n.size;
+    bool negative = n.is_negative && !(size == 1 && digits[0] == 0);
+
+    seed ^= bigint_hash_mix(seed ^ BIGINT_HASH_P0, BIGINT_HASH_P1);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        uint64_t a = bigint_hash_pack(digits + i, 16), b = bigint_hash_pack(digits + i + 16, 16);
+        seed = bigint_hash_mix(a ^ BIGINT_HASH_P1, b ^ seed);
+    }
+    if (i < size) {
+        size_t left = size - i, first = left < 16 ? left : 16;
+        uint64_t a = bigint_hash_pack(digits + i, first), b = bigint_hash_pack(digits + i + first, left - first);
+        seed = bigint_hash_mix(a ^ BIGINT_HASH_P1, b ^ seed);
+    }
+    return bigint_hash_mix(seed ^ BIGINT_HASH_P0, ((uint64_t)size << 1 | negative) ^ BIGINT_HASH_P2);
+}
+
+/* An intern table that keeps one canonical instance of each value
+* Interned values are owned by the table and stay at the same address until
+* the table is deleted, so two interned values are equal exactly when their
+* pointers are. The table is not synchronized.
+*/
+typedef struct {
+    bigint **slots;
+    uint64_t *hashes;
+    size_t count;
+    size_t capacity;
+    uint64_t seed;
+} bigint_intern_table;
+
+/* Create an empty intern table
+* @param seed The seed for hashing values
+* @return The table, to be freed with bigint_intern_delete
+*/
+bigint_intern_table bigint_intern_new(uint64_t seed) {
+    bigint_intern_table table;
+    table.capacity = 16;
+    table.count = 0;
+    table.seed = seed;
+    table.slots = calloc(table.capacity, sizeof(bigint *));
+    table.hashes = malloc(table.capacity * sizeof(uint64_t));
+    return table;
+}
+
+// Whether a normalized bigint has the same value as another, without modifying either
+bool bigint_intern_equal(const bigint *normalized, bigint n) {
+    n = bigint_trimmed(n);
+    bool negative = n.is_negative && !(n.size == 1 && n.digits[0] == 0);
+    return normalized->size == n.size && normalized->is_negative == negative &&
+           memcmp(normalized->digits, n.digits, n.size * sizeof(int64_t)) == 0;
+}
+
+// Double the capacity of an intern table and reinsert its values
+void bigint_intern_grow(bigint_intern_table *table) {
+    size_t capacity = table->capacity * 2;
+    bigint **slots = calloc(capacity, sizeof(bigint *));
+    uint64_t *hashes = malloc(capacity * sizeof(uint64_t));
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i]) {
+            size_t j = table->hashes[i] & (capacity - 1);
+            while (slots[j]) {
+                j = (j + 1) & (capacity - 1);
+            }
+            slots[j] = table->slots[i];
+            hashes[j] = table->hashes[i];
+        }
+    }
+    free(table->slots);
+    free(table->hashes);
+    table->slots = slots;
+    table->hashes = hashes;
+    table->capacity = capacity;
+}
+
+/* Find or add the canonical instance of a value
+* @param table The intern table
+* @param n The value, which is copied if it is new and never taken over
+* @return The canonical instance, owned by the table
+*/
+const bigint *bigint_intern(bigint_intern_table *table, bigint n) {
+    uint64_t hash = bigint_hash(n, table->seed);
+    size_t mask = table->capacity - 1, i = hash & mask;
+    for (; table->slots[i]; i = (i + 1) & mask) {
+        if (table->hashes[i] == hash && bigint_intern_equal(table->slots[i], n)) {
+            return table->slots[i];
+        }
+    }
+
+    bigint *value = malloc(sizeof(bigint));
+    n = bigint_trimmed(n);
+    *value = bigint_copy(n);
+    value->is_negative = n.is_negative && !(n.size == 1 && n.digits[0] == 0);
+    table->slots[i] = value;
+    table->hashes[i] = hash;
+    if (2 * ++table->count > table->capacity) {
+        bigint_intern_grow(table);
+    }
+    return value;
+}
+
+/* Free an intern table and all of its values
+* @param table The table
+*/
+void bigint_intern_delete(bigint_intern_table *table) {
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i]) {
+            bigint_delete(*table->slots[i]);
+            free(table->slots[i]);
+        }
+    }
+    free(table->slots);
+    free(table->hashes);
+    table->slots = NULL;
+    table->hashes = NULL;
+    table->count = table->capacity = 0;
+}
+
 
 bigint bigint_add(bigint a, bigint b);
 
@@ -375,457 +1103,5337 @@ bigint bigint_add(bigint a, bigint b) {
 }
 
 
-bigint bigint_inc(bigint *n) {
-    bigint one = bigint_from_string("1"), tmp;
-    tmp = *n;
-    *n = bigint_add(*n, one);
-    bigint_delete(tmp);
-    bigint_delete(one);
-    return *n;
-}
+/* Operations with a machine word operand
+* Each one is a single pass over the digits that works in place, with no
+* temporary bigints.
+*/
 
-bigint bigint_dec(bigint *n) {
-    bigint one = bigint_from_string("1"), tmp;
-    tmp = *n;
-    *n = bigint_sub(*n, one);
-    bigint_delete(tmp);
-    bigint_delete(one);
-    return *n;
+// Skip the leading zeros of a bigint in place
+void bigint_normalize(bigint *n) {
+    bigint_remove_leading_zeros(n);
+    if (n->size == 1 && n->digits[0] == 0) {
+        n->is_negative = false;
+    }
 }
 
-bigint bigint_mul(bigint a, bigint b) {
-    if (bigint_is_64_bit(a) && bigint_is_64_bit(b)) {
-        return bigint_from_int(bigint_to_int(a) * bigint_to_int(b));
+// Compare |n| with b: -1, 0 or 1
+int bigint_cmpabs_ui(bigint n, uint64_t b) {
+    size_t start = 0;
+    while (start < n.size - 1 && n.digits[start] == 0) {
+        start++;
     }
-
-
-    bigint result;
-    result.size = a.size + b.size;
-    result.digits = malloc(result.size * sizeof(int64_t));
-    
-    // Multiply the digits
-    for (size_t i = 0; i < result.size; i++) {
-        result.digits[i] = 0;
+    // UINT64_MAX has 20 digits
+    if (n.size - start > 20) {
+        return 1;
     }
-    for (size_t i = 0; i < a.size; i++) {
-        for (size_t j = 0; j < b.size; j++) {
-            result.digits[result.size - i - j - 1] += a.digits[a.size - i - 1] * b.digits[b.size - j - 1];
+    uint64_t value = 0;
+    for (size_t i = start; i < n.size; i++) {
+        if (value > (UINT64_MAX - n.digits[i]) / 10) {
+            return 1;
         }
+        value = value * 10 + n.digits[i];
     }
+    return value < b ? -1 : value > b;
+}
 
-    // Normalize the result
-    int64_t carry = 0;
-    for (size_t i = 0; i < result.size; i++) {
-        int64_t sum = result.digits[result.size - i - 1] + carry;
-        result.digits[result.size - i - 1] = sum % 10;
-        carry = sum / 10;
+// Prepend the digits of a carry to a bigint
+void bigint_prepend_carry(bigint *n, uint64_t carry) {
+    size_t extra = 0;
+    for (uint64_t c = carry; c > 0; c /= 10) {
+        extra++;
     }
+    n->digits = realloc(n->digits, (n->size + extra) * sizeof(int64_t));
+    memmove(n->digits + extra, n->digits, n->size * sizeof(int64_t));
+    n->size += extra;
+    for (size_t i = extra; i > 0; i--) {
+        n->digits[i - 1] = carry % 10;
+        carry /= 10;
+    }
+}
 
-    // If there is a carry, add another digit
+// |n| += b
+void bigint_addabs_ui(bigint *n, uint64_t b) {
+    uint64_t carry = b;
+    for (size_t i = n->size; i > 0 && carry > 0; i--) {
+        uint64_t sum = n->digits[i - 1] + carry % 10;
+        n->digits[i - 1] = sum % 10;
+        carry = carry / 10 + sum / 10;
+    }
     if (carry > 0) {
-        result.size++;
-        result.digits = realloc(result.digits, result.size * sizeof(int64_t));
-        for (size_t i = result.size - 1; i > 0; i--) {
-            result.digits[i] = result.digits[i - 1];
+        bigint_prepend_carry(n, carry);
+    }
+}
+
+// |n| -= b, where |n| >= b
+void bigint_subabs_ui(bigint *n, uint64_t b) {
+    uint64_t borrow = b;
+    for (size_t i = n->size; i > 0 && borrow > 0; i--) {
+        int64_t diff = n->digits[i - 1] - (int64_t)(borrow % 10);
+        borrow /= 10;
+        if (diff < 0) {
+            diff += 10;
+            borrow++;
+        }
+        n->digits[i - 1] = diff;
+    }
+}
+
+// Replace |n| with b - |n|, where |n| < b
+void bigint_rsubabs_ui(bigint *n, uint64_t b) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < n->size; i++) {
+        value = value * 10 + n->digits[i];
+    }
+    bool is_negative = n->is_negative;
+    bigint_delete(*n);
+    *n = bigint_zero();
+    n->is_negative = is_negative;
+    bigint_addabs_ui(n, b - value);
+}
+
+/* Add a machine word to a bigint in place
+* @param n The bigint to modify
+* @param b The word to add
+* @return The modified value
+*/
+bigint bigint_add_ui_inplace(bigint *n, uint64_t b) {
+    if (!n->is_negative) {
+        bigint_addabs_ui(n, b);
+    } else if (bigint_cmpabs_ui(*n, b) >= 0) {
+        bigint_subabs_ui(n, b);
+    } else {
+        bigint_rsubabs_ui(n, b);
+        n->is_negative = false;
+    }
+    bigint_normalize(n);
+    return *n;
+}
+
+/* Subtract a machine word from a bigint in place
+* @param n The bigint to modify
+* @param b The word to subtract
+* @return The modified value
+*/
+bigint bigint_sub_ui_inplace(bigint *n, uint64_t b) {
+    if (n->is_negative) {
+        bigint_addabs_ui(n, b);
+    } else if (bigint_cmpabs_ui(*n, b) >= 0) {
+        bigint_subabs_ui(n, b);
+    } else {
+        bigint_rsubabs_ui(n, b);
+        n->is_negative = true;
+    }
+    bigint_normalize(n);
+    return *n;
+}
+
+/* Multiply a bigint by a machine word in place
+* @param n The bigint to modify
+* @param b The word to multiply by
+* @return The modified value
+*/
+bigint bigint_mul_ui_inplace(bigint *n, uint64_t b) {
+    if (b > UINT64_MAX / 10) {
+        // The carry could overflow, so split b = high * 10^9 + low
+        bigint low = bigint_copy(*n);
+        bigint_mul_ui_inplace(&low, b % 1000000000);
+        bigint_mul_ui_inplace(n, b / 1000000000);
+        n->digits = realloc(n->digits, (n->size + 9) * sizeof(int64_t));
+        memset(n->digits + n->size, 0, 9 * sizeof(int64_t));
+        n->size += 9;
+        bigint tmp = *n;
+        *n = bigint_add(*n, low);
+        bigint_delete(tmp);
+        bigint_delete(low);
+        bigint_normalize(n);
+        return *n;
+    }
+    uint64_t carry = 0;
+    for (size_t i = n->size; i > 0; i--) {
+        uint64_t product = (uint64_t)n->digits[i - 1] * b + carry;
+        n->digits[i - 1] = product % 10;
+        carry = product / 10;
+    }
+    if (carry > 0) {
+        bigint_prepend_carry(n, carry);
+    }
+    bigint_normalize(n);
+    return *n;
+}
+
+/* Divide a bigint by a machine word in place
+* The quotient is truncated toward zero, like bigint_divmod.
+* @param n The bigint to divide
+* @param d The word to divide by, nonzero and at most UINT64_MAX / 10
+* @return The remainder of |n| divided by d
+*/
+uint64_t bigint_divmod_ui_inplace(bigint *n, uint64_t d) {
+    assert(d != 0 && d <= UINT64_MAX / 10);
+    uint64_t rem = 0;
+    for (size_t i = 0; i < n->size; i++) {
+        uint64_t value = rem * 10 + n->digits[i];
+        n->digits[i] = value / d;
+        rem = value % d;
+    }
+    bigint_normalize(n);
+    return rem;
+}
+
+bigint bigint_add_ui(bigint a, uint64_t b) {
+    bigint result = bigint_copy(a);
+    return bigint_add_ui_inplace(&result, b);
+}
+
+bigint bigint_sub_ui(bigint a, uint64_t b) {
+    bigint result = bigint_copy(a);
+    return bigint_sub_ui_inplace(&result, b);
+}
+
+bigint bigint_mul_ui(bigint a, uint64_t b) {
+    bigint result = bigint_copy(a);
+    return bigint_mul_ui_inplace(&result, b);
+}
+
+/* Divide a bigint by a machine word
+* @param a The bigint to divide
+* @param d The word to divide by, nonzero and at most UINT64_MAX / 10
+* @param remainder Set to the remainder of |a| divided by d
+* @return A new bigint with the quotient, truncated toward zero
+*/
+bigint bigint_divmod_ui(bigint a, uint64_t d, uint64_t *remainder) {
+    bigint result = bigint_copy(a);
+    *remainder = bigint_divmod_ui_inplace(&result, d);
+    return result;
+}
+
+/* Find the remainder of a bigint divided by a machine word
+* @param a The bigint to divide
+* @param d The word to divide by, nonzero and at most UINT64_MAX / 10
+* @return The remainder of |a| divided by d
+*/
+uint64_t bigint_mod_ui(bigint a, uint64_t d) {
+    assert(d != 0 && d <= UINT64_MAX / 10);
+    uint64_t rem = 0;
+    for (size_t i = 0; i < a.size; i++) {
+        rem = (rem * 10 + a.digits[i]) % d;
+    }
+    return rem;
+}
+
+/* Test whether a bigint is divisible by a machine word
+* @param a The bigint to test
+* @param d The word to divide by, nonzero and at most UINT64_MAX / 10
+* @return Whether d divides a
+*/
+bool bigint_divisible_ui_p(bigint a, uint64_t d) {
+    return bigint_mod_ui(a, d) == 0;
+}
+
+/* Compare a bigint with a signed machine word
+* @param a The bigint to compare
+* @param b The word to compare with
+* @return A negative value if a < b, zero if a == b, or a positive value if a > b
+*/
+int bigint_cmp_si(bigint a, int64_t b) {
+    bool a_negative = a.is_negative && bigint_cmpabs_ui(a, 0) != 0;
+    if (a_negative != (b < 0)) {
+        return a_negative ? -1 : 1;
+    }
+    uint64_t magnitude = b < 0 ? -(uint64_t)b : (uint64_t)b;
+    int cmp = bigint_cmpabs_ui(a, magnitude);
+    return a_negative ? -cmp : cmp;
+}
+
+bigint bigint_inc(bigint *n) {
+    return bigint_add_ui_inplace(n, 1);
+}
+
+bigint bigint_dec(bigint *n) {
+    return bigint_sub_ui_inplace(n, 1);
+}
+
+/* Limbs are groups of decimal digits used internally by the multiplication
+* routines. They are stored least significant first, each in [0, BIGINT_LIMB_BASE).
+*/
+#define BIGINT_LIMB_DIGITS 4
+#define BIGINT_LIMB_BASE 10000
+
+size_t bigint_limb_count(bigint n) {
+    return (n.size + BIGINT_LIMB_DIGITS - 1) / BIGINT_LIMB_DIGITS;
+}
+
+/* Pack the decimal digits of a bigint into limbs
+* @param n The bigint to pack
+* @param limbs The output array, with room for `bigint_limb_count(n)` limbs
+*/
+void bigint_pack_limbs(bigint n, int64_t *limbs) {
+    size_t count = bigint_limb_count(n);
+    for (size_t i = 0; i < count; i++) {
+        int64_t limb = 0;
+        for (size_t j = BIGINT_LIMB_DIGITS; j > 0; j--) {
+            size_t pos = i * BIGINT_LIMB_DIGITS + j - 1;
+            limb *= 10;
+            if (pos < n.size) {
+                limb += n.digits[n.size - pos - 1];
+            }
+        }
+        limbs[i] = limb;
+    }
+}
+
+/* Unpack normalized limbs into a new bigint
+* @param limbs The limbs to unpack
+* @param count The number of limbs
+* @param is_negative The sign of the result
+* @return A new bigint with the value of the limbs
+*/
+bigint bigint_unpack_limbs(const int64_t *limbs, size_t count, bool is_negative) {
+    if (count == 0) {
+        return bigint_zero();
+    }
+    bigint result;
+    result.is_negative = is_negative;
+    result.size = count * BIGINT_LIMB_DIGITS;
+    result.digits = malloc(result.size * sizeof(int64_t));
+    for (size_t i = 0; i < count; i++) {
+        int64_t limb = limbs[i];
+        for (size_t j = 0; j < BIGINT_LIMB_DIGITS; j++) {
+            result.digits[result.size - i * BIGINT_LIMB_DIGITS - j - 1] = limb % 10;
+            limb /= 10;
         }
-        result.digits[0] = carry;
     }
-    
     bigint_remove_leading_zeros(&result);
-    
+    return result;
+}
+
+// r[0..rn) += x[0..xn), propagating the carry no further than rn limbs
+void bigint_limbs_add_into(int64_t *r, size_t rn, const int64_t *x, size_t xn) {
+    int64_t carry = 0;
+    size_t i;
+    for (i = 0; i < xn && i < rn; i++) {
+        int64_t sum = r[i] + x[i] + carry;
+        carry = sum >= BIGINT_LIMB_BASE;
+        r[i] = carry ? sum - BIGINT_LIMB_BASE : sum;
+    }
+    for (; carry && i < rn; i++) {
+        int64_t sum = r[i] + carry;
+        carry = sum >= BIGINT_LIMB_BASE;
+        r[i] = carry ? sum - BIGINT_LIMB_BASE : sum;
+    }
+}
+
+// r[0..rn) -= x[0..xn), where the difference must not be negative
+void bigint_limbs_sub_into(int64_t *r, size_t rn, const int64_t *x, size_t xn) {
+    int64_t borrow = 0;
+    size_t i;
+    for (i = 0; i < xn && i < rn; i++) {
+        int64_t diff = r[i] - x[i] - borrow;
+        borrow = diff < 0;
+        r[i] = borrow ? diff + BIGINT_LIMB_BASE : diff;
+    }
+    for (; borrow && i < rn; i++) {
+        int64_t diff = r[i] - borrow;
+        borrow = diff < 0;
+        r[i] = borrow ? diff + BIGINT_LIMB_BASE : diff;
+    }
+}
+
+// Schoolbook product of two limb arrays into r[0..an+bn)
+void bigint_limbs_mul_basecase(const int64_t *a, size_t an, const int64_t *b, size_t bn, int64_t *r) {
+    memset(r, 0, (an + bn) * sizeof(int64_t));
+    for (size_t i = 0; i < an; i++) {
+        if (a[i] == 0) {
+            continue;
+        }
+        for (size_t j = 0; j < bn; j++) {
+            r[i + j] += a[i] * b[j];
+        }
+    }
+
+    // Normalize the result
+    int64_t carry = 0;
+    for (size_t i = 0; i < an + bn; i++) {
+        int64_t sum = r[i] + carry;
+        r[i] = sum % BIGINT_LIMB_BASE;
+        carry = sum / BIGINT_LIMB_BASE;
+    }
+}
+
+/* Number theoretic transforms
+* Above bigint_thresholds.ntt limbs, products are convolutions computed
+* with NTTs modulo two primes of the form c * 2^k + 1. Each coefficient of
+* the product is below n * BIGINT_LIMB_BASE^2, which is less than the
+* product of the primes, so Garner's method recovers it exactly.
+*/
+#define BIGINT_NTT_PRIME1 469762049
+#define BIGINT_NTT_PRIME2 167772161
+// 3 generates the multiplicative group of both primes
+#define BIGINT_NTT_GENERATOR 3
+// The longest transform both primes support
+#define BIGINT_NTT_MAX_LENGTH ((size_t)1 << 25)
+
+// a^e mod p for word-sized p
+uint64_t bigint_powmod_ui(uint64_t a, uint64_t e, uint64_t p) {
+    uint64_t result = 1 % p;
+    a %= p;
+    while (e > 0) {
+        if (e & 1) {
+            result = result * a % p;
+        }
+        a = a * a % p;
+        e >>= 1;
+    }
+    return result;
+}
+
+/* Transform an array in place modulo a prime
+* @param a The array, of length n, with entries below p
+* @param n The length, a power of two dividing p - 1
+* @param p The prime
+* @param inverse Whether to apply the inverse transform, including the 1/n scaling
+*/
+void bigint_ntt(uint32_t *a, size_t n, uint32_t p, bool inverse) {
+    // Bit-reversal permutation
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            uint32_t t = a[i];
+            a[i] = a[j];
+            a[j] = t;
+        }
+    }
+
+    uint32_t *roots = malloc((n / 2 + 1) * sizeof(uint32_t));
+    for (size_t len = 2; len <= n; len <<= 1) {
+        uint64_t root = bigint_powmod_ui(BIGINT_NTT_GENERATOR, (p - 1) / len, p);
+        if (inverse) {
+            root = bigint_powmod_ui(root, p - 2, p);
+        }
+        size_t half = len / 2;
+        roots[0] = 1;
+        for (size_t k = 1; k < half; k++) {
+            roots[k] = (uint32_t)((uint64_t)roots[k - 1] * root % p);
+        }
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < half; k++) {
+                uint32_t u = a[i + k];
+                uint32_t v = (uint32_t)((uint64_t)a[i + k + half] * roots[k] % p);
+                a[i + k] = u + v >= p ? u + v - p : u + v;
+                a[i + k + half] = u >= v ? u - v : u + p - v;
+            }
+        }
+    }
+    free(roots);
+
+    if (inverse) {
+        uint64_t scale = bigint_powmod_ui(n, p - 2, p);
+        for (size_t i = 0; i < n; i++) {
+            a[i] = (uint32_t)(a[i] * scale % p);
+        }
+    }
+}
+
+// The cyclic convolution of two limb arrays modulo p, into out[0..n)
+void bigint_ntt_convolve(const int64_t *a, size_t an, const int64_t *b, size_t bn, size_t n, uint32_t p, uint32_t *out) {
+    uint32_t *fb = calloc(n, sizeof(uint32_t));
+    memset(out, 0, n * sizeof(uint32_t));
+    for (size_t i = 0; i < an; i++) {
+        out[i] = (uint32_t)a[i];
+    }
+    for (size_t i = 0; i < bn; i++) {
+        fb[i] = (uint32_t)b[i];
+    }
+    bigint_ntt(out, n, p, false);
+    bigint_ntt(fb, n, p, false);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (uint32_t)((uint64_t)out[i] * fb[i] % p);
+    }
+    free(fb);
+    bigint_ntt(out, n, p, true);
+}
+
+// NTT product of two limb arrays into r[0..an+bn)
+void bigint_limbs_mul_ntt(const int64_t *a, size_t an, const int64_t *b, size_t bn, int64_t *r) {
+    size_t n = 1;
+    while (n < an + bn) {
+        n <<= 1;
+    }
+    assert(n <= BIGINT_NTT_MAX_LENGTH);
+    uint32_t *c1 = malloc(n * sizeof(uint32_t));
+    uint32_t *c2 = malloc(n * sizeof(uint32_t));
+    bigint_ntt_convolve(a, an, b, bn, n, BIGINT_NTT_PRIME1, c1);
+    bigint_ntt_convolve(a, an, b, bn, n, BIGINT_NTT_PRIME2, c2);
+
+    // Garner: x = c1 + p1 * ((c2 - c1) / p1 mod p2), then carry into limbs
+    uint64_t p1_inverse = bigint_powmod_ui(BIGINT_NTT_PRIME1, BIGINT_NTT_PRIME2 - 2, BIGINT_NTT_PRIME2);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < an + bn; i++) {
+        uint64_t diff = (c2[i] + BIGINT_NTT_PRIME2 - c1[i] % BIGINT_NTT_PRIME2) % BIGINT_NTT_PRIME2;
+        uint64_t x = c1[i] + (uint64_t)BIGINT_NTT_PRIME1 * (diff * p1_inverse % BIGINT_NTT_PRIME2) + carry;
+        r[i] = (int64_t)(x % BIGINT_LIMB_BASE);
+        carry = x / BIGINT_LIMB_BASE;
+    }
+    free(c1);
+    free(c2);
+}
+
+/* Multiply two limb arrays
+* Uses Karatsuba's method above bigint_thresholds.karatsuba limbs, and
+* NTTs above bigint_thresholds.ntt limbs.
+* @param a The first limb array
+* @param an The number of limbs in a
+* @param b The second limb array
+* @param bn The number of limbs in b
+* @param r The output array, with room for an + bn limbs
+*/
+void bigint_limbs_mul(const int64_t *a, size_t an, const int64_t *b, size_t bn, int64_t *r) {
+    if (an < bn) {
+        const int64_t *t = a;
+        a = b;
+        b = t;
+        size_t tn = an;
+        an = bn;
+        bn = tn;
+    }
+    if (bn < bigint_thresholds.karatsuba) {
+        bigint_limbs_mul_basecase(a, an, b, bn, r);
+        return;
+    }
+    if (bn >= bigint_thresholds.ntt && an + bn <= BIGINT_NTT_MAX_LENGTH) {
+        bigint_limbs_mul_ntt(a, an, b, bn, r);
+        return;
+    }
+
+    if (an >= 2 * bn) {
+        // Unbalanced operands: multiply b by each bn-sized chunk of a
+        int64_t *tmp = malloc(2 * bn * sizeof(int64_t));
+        memset(r, 0, (an + bn) * sizeof(int64_t));
+        for (size_t i = 0; i < an; i += bn) {
+            size_t len = an - i < bn ? an - i : bn;
+            bigint_limbs_mul(a + i, len, b, bn, tmp);
+            bigint_limbs_add_into(r + i, an + bn - i, tmp, len + bn);
+        }
+        free(tmp);
+        return;
+    }
+
+    // Split both operands at m limbs: a = a1 * B^m + a0, b = b1 * B^m + b0
+    size_t m = an / 2;
+    const int64_t *a0 = a, *a1 = a + m, *b0 = b, *b1 = b + m;
+    size_t a1n = an - m, b1n = bn - m;
+
+    // z0 = a0 * b0 and z2 = a1 * b1 go directly into the result
+    bigint_limbs_mul(a0, m, b0, m, r);
+    bigint_limbs_mul(a1, a1n, b1, b1n, r + 2 * m);
+
+    // z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+    size_t san = a1n + 1, sbn = (b1n > m ? b1n : m) + 1;
+    int64_t *sa = calloc(san + sbn + san + sbn, sizeof(int64_t));
+    int64_t *sb = sa + san;
+    int64_t *z1 = sb + sbn;
+    memcpy(sa, a1, a1n * sizeof(int64_t));
+    bigint_limbs_add_into(sa, san, a0, m);
+    memcpy(sb, b1, b1n * sizeof(int64_t));
+    bigint_limbs_add_into(sb, sbn, b0, m);
+    bigint_limbs_mul(sa, san, sb, sbn, z1);
+    bigint_limbs_sub_into(z1, san + sbn, r, 2 * m);
+    bigint_limbs_sub_into(z1, san + sbn, r + 2 * m, a1n + b1n);
+
+    size_t z1n = san + sbn;
+    while (z1n > 0 && z1[z1n - 1] == 0) {
+        z1n--;
+    }
+    bigint_limbs_add_into(r + m, an + bn - m, z1, z1n);
+    free(sa);
+}
+
+bigint bigint_mul(bigint a, bigint b) {
+    if (bigint_is_64_bit(a) && bigint_is_64_bit(b)) {
+        return bigint_from_int(bigint_to_int(a) * bigint_to_int(b));
+    }
+
+    size_t an = bigint_limb_count(a), bn = bigint_limb_count(b);
+    if (an == 0 || bn == 0) {
+        return bigint_zero();
+    }
+
+    int64_t *limbs = malloc((an + bn + an + bn) * sizeof(int64_t));
+    int64_t *al = limbs, *bl = limbs + an, *rl = limbs + an + bn;
+    bigint_pack_limbs(a, al);
+    bigint_pack_limbs(b, bl);
+    bigint_limbs_mul(al, an, bl, bn, rl);
+
     // Check negative
-    result.is_negative = a.is_negative != b.is_negative;
+    bigint result = bigint_unpack_limbs(rl, an + bn, a.is_negative != b.is_negative);
+    free(limbs);
     
     return result;
 }
 
 
-bigint bigint_divmod(bigint numerator, bigint denominator, bigint *remainder) {
-    if (bigint_is_64_bit(numerator) && bigint_is_64_bit(denominator)) {
-        int64_t quotient = bigint_to_int(numerator) / bigint_to_int(denominator);
-        int64_t rem = bigint_to_int(numerator) % bigint_to_int(denominator);
-        *remainder = bigint_from_int(rem);
-        return bigint_from_int(quotient);
+/* A multi-operand accumulator with deferred carries
+* The running total is kept in signed slots, one per decimal digit and least
+* significant first, which may hold any value while their magnitudes stay
+* below BIGINT_ACC_LIMIT. Adding a term is one pass over its digits with no
+* carries; a carry pass runs only when a slot could otherwise overflow.
+*/
+typedef struct {
+    int64_t *slots;
+    size_t size;
+    size_t capacity;
+    uint64_t bound;
+} bigint_acc;
+
+// The largest slot magnitude allowed before carries are resolved
+#ifndef BIGINT_ACC_LIMIT
+#define BIGINT_ACC_LIMIT ((uint64_t)1 << 62)
+#endif
+
+// Products with a factor of at most this many digits are accumulated digit by digit
+#define BIGINT_ACC_MUL_DIRECT 16
+
+/* Create an accumulator holding zero
+* @return The accumulator, to be freed with bigint_acc_delete
+*/
+bigint_acc bigint_acc_new() {
+    bigint_acc acc = {NULL, 0, 0, 0};
+    return acc;
+}
+
+// Make room for at least size slots, zeroing the new ones
+void bigint_acc_reserve(bigint_acc *acc, size_t size) {
+    if (size > acc->capacity) {
+        size_t capacity = acc->capacity ? acc->capacity : 16;
+        while (capacity < size) {
+            capacity *= 2;
+        }
+        acc->slots = realloc(acc->slots, capacity * sizeof(int64_t));
+        acc->capacity = capacity;
     }
+    if (size > acc->size) {
+        memset(acc->slots + acc->size, 0, (size - acc->size) * sizeof(int64_t));
+        acc->size = size;
+    }
+}
 
-    bigint quotient = bigint_from_string("0");
-    
-    bool negative = numerator.is_negative != denominator.is_negative;
-    numerator.is_negative = false;
-    denominator.is_negative = false;
-    
-    bigint tmp1, tmp2;
-    numerator = bigint_copy(numerator);
-
-    // Divide the numerator by the denominator
-    // This is a very slow algorithm
-    // It works by subtracting the denominator from the numerator until the numerator is less than the denominator
-    // The number of times the denominator is subtracted is the quotient
-    // The remainder is the numerator after the last subtraction
-    while (bigint_gtzero(numerator)) {
-        tmp1 = numerator;
-        numerator = bigint_sub(numerator, denominator);
-        bigint_delete(tmp1);
-        if (bigint_ltzero(numerator)) {
-            break;
+// Resolve carries so every slot is a digit in [0, 9], except the top ones of a negative total
+void bigint_acc_carry(bigint_acc *acc) {
+    int64_t carry = 0;
+    for (size_t i = 0; i < acc->size; i++) {
+        int64_t value = acc->slots[i] + carry;
+        int64_t digit = value % 10;
+        carry = value / 10;
+        if (digit < 0) {
+            digit += 10;
+            carry--;
         }
-        bigint_inc(&quotient);
+        acc->slots[i] = digit;
     }
-    if (bigint_ltzero(numerator)) {
-        tmp1 = numerator;
-        numerator = bigint_add(numerator, denominator);
-        bigint_delete(tmp1);
+    // A nonzero carry is the signed top of the value, in as many slots as it needs
+    while (carry >= 10 || carry <= -10) {
+        bigint_acc_reserve(acc, acc->size + 1);
+        acc->slots[acc->size - 1] = carry % 10;
+        carry /= 10;
+    }
+    if (carry != 0) {
+        bigint_acc_reserve(acc, acc->size + 1);
+        acc->slots[acc->size - 1] = carry;
+    }
+    acc->bound = 9;
+    while (acc->size > 0 && acc->slots[acc->size - 1] == 0) {
+        acc->size--;
+    }
+}
+
+// Make sure each slot can take up to growth more in magnitude
+void bigint_acc_headroom(bigint_acc *acc, uint64_t growth) {
+    assert(growth <= BIGINT_ACC_LIMIT / 2);
+    if (acc->bound + growth > BIGINT_ACC_LIMIT) {
+        bigint_acc_carry(acc);
     }
+    acc->bound += growth;
+}
 
-    // Set the remainder
-    *remainder = numerator;
+// Add sign * k * |n| * 10^shift for a word k with 9k within the slot limit
+void bigint_acc_addmul_shifted(bigint_acc *acc, bigint n, uint64_t k, size_t shift, bool negative) {
+    if (k == 0) {
+        return;
+    }
+    bigint_acc_headroom(acc, 9 * k);
+    bigint_acc_reserve(acc, n.size + shift);
+    int64_t *slots = acc->slots + shift;
+    int64_t scale = negative ? -(int64_t)k : (int64_t)k;
+    for (size_t i = 0; i < n.size; i++) {
+        slots[i] += scale * n.digits[n.size - 1 - i];
+    }
+}
 
-    bigint_remove_leading_zeros(&quotient);
+/* Add a bigint to an accumulator
+* @param acc The accumulator
+* @param n The value to add
+*/
+void bigint_acc_add(bigint_acc *acc, bigint n) {
+    bigint_acc_addmul_shifted(acc, n, 1, 0, n.is_negative);
+}
+
+/* Subtract a bigint from an accumulator
+* @param acc The accumulator
+* @param n The value to subtract
+*/
+void bigint_acc_sub(bigint_acc *acc, bigint n) {
+    bigint_acc_addmul_shifted(acc, n, 1, 0, !n.is_negative);
+}
+
+/* Add a multiple of a bigint to an accumulator
+* @param acc The accumulator
+* @param n The value to scale
+* @param k The word to scale it by
+*/
+void bigint_acc_addmul_ui(bigint_acc *acc, bigint n, uint64_t k) {
+    // Split k in decimal so each pass stays within the slot limit
+    const uint64_t split = 1000000000;
+    bigint_acc_addmul_shifted(acc, n, k % split, 0, n.is_negative);
+    bigint_acc_addmul_shifted(acc, n, k / split, 9, n.is_negative);
+}
+
+/* Add the product of two bigints to an accumulator
+* Short factors are multiplied digit by digit straight into the slots, and
+* longer ones go through bigint_mul.
+* @param acc The accumulator
+* @param a The first factor
+* @param b The second factor
+*/
+void bigint_acc_addmul(bigint_acc *acc, bigint a, bigint b) {
+    if (a.size > b.size) {
+        bigint tmp = a;
+        a = b;
+        b = tmp;
+    }
+    if (a.size > BIGINT_ACC_MUL_DIRECT) {
+        bigint product = bigint_mul(a, b);
+        bigint_acc_add(acc, product);
+        bigint_delete(product);
+        return;
+    }
+    bool negative = a.is_negative != b.is_negative;
+    for (size_t i = 0; i < a.size; i++) {
+        int64_t digit = a.digits[a.size - 1 - i];
+        bigint_acc_addmul_shifted(acc, b, (uint64_t)digit, i, negative);
+    }
+}
+
+/* Resolve an accumulator into a bigint
+* The accumulator keeps its value and can take more terms afterwards.
+* @param acc The accumulator
+* @return A new bigint with the accumulated value
+*/
+bigint bigint_acc_value(bigint_acc *acc) {
+    bigint_acc_carry(acc);
+    if (acc->size == 0) {
+        return bigint_zero();
+    }
 
+    // A negative top means a negative total: resolve its magnitude instead
+    bool negative = acc->slots[acc->size - 1] < 0;
+    if (negative) {
+        for (size_t i = 0; i < acc->size; i++) {
+            acc->slots[i] = -acc->slots[i];
+        }
+        bigint_acc_carry(acc);
+    }
+    bigint result;
+    result.is_negative = negative;
+    result.size = acc->size;
+    result.digits = malloc(result.size * sizeof(int64_t));
+    for (size_t i = 0; i < acc->size; i++) {
+        result.digits[i] = acc->slots[acc->size - 1 - i];
+    }
     if (negative) {
-        quotient.is_negative = true;
-        remainder->is_negative = true;
+        for (size_t i = 0; i < acc->size; i++) {
+            acc->slots[i] = -acc->slots[i];
+        }
     }
+    return result;
+}
 
-    return quotient;
+/* Reset an accumulator to zero, keeping its storage
+* @param acc The accumulator
+*/
+void bigint_acc_clear(bigint_acc *acc) {
+    acc->size = 0;
+    acc->bound = 0;
 }
 
-bigint bigint_div(bigint a, bigint b) {
-    if (bigint_is_64_bit(a) && bigint_is_64_bit(b)) {
-        return bigint_from_int(bigint_to_int(a) / bigint_to_int(b));
+/* Free an accumulator
+* @param acc The accumulator
+*/
+void bigint_acc_delete(bigint_acc *acc) {
+    free(acc->slots);
+    acc->slots = NULL;
+    acc->size = acc->capacity = 0;
+    acc->bound = 0;
+}
+
+/* Schoolbook long division of decimal digit arrays
+* @param n The numerator digits, most significant first
+* @param nn The number of numerator digits
+* @param d The denominator digits, with no leading zeros
+* @param dn The number of denominator digits
+* @param q The output quotient, with room for nn digits
+* @param r The output remainder, with room for dn digits
+*/
+void bigint_digits_divmod(const int64_t *n, size_t nn, const int64_t *d, size_t dn, int64_t *q, int64_t *r) {
+    // The running remainder has one more digit than the denominator
+    int64_t *rem = calloc(dn + 1, sizeof(int64_t));
+
+    // Estimate each quotient digit from the leading digits of both operands
+    size_t top = dn + 1 < 18 ? dn + 1 : 18;
+    int64_t d_top = 0;
+    for (size_t i = 0; i < top - 1; i++) {
+        d_top = d_top * 10 + d[i];
     }
 
-    bigint remainder;
-    bigint result = bigint_divmod(a, b, &remainder);
-    bigint_delete(remainder);
+    for (size_t i = 0; i < nn; i++) {
+        memmove(rem, rem + 1, dn * sizeof(int64_t));
+        rem[dn] = n[i];
+
+        int64_t r_top = 0;
+        for (size_t j = 0; j < top; j++) {
+            r_top = r_top * 10 + rem[j];
+        }
+        int64_t digit = r_top / (d_top + 1);
+
+        // Subtract digit * d, then correct the estimate
+        if (digit > 0) {
+            int64_t carry = 0;
+            for (size_t j = dn + 1; j > 0; j--) {
+                int64_t diff = rem[j - 1] - carry - (j > 1 ? digit * d[j - 2] : 0);
+                carry = 0;
+                if (diff < 0) {
+                    carry = (9 - diff) / 10;
+                    diff += carry * 10;
+                }
+                rem[j - 1] = diff;
+            }
+        }
+        while (true) {
+            // Compare rem against d
+            int cmp = rem[0] > 0 ? 1 : 0;
+            for (size_t j = 0; cmp == 0 && j < dn; j++) {
+                if (rem[j + 1] != d[j]) {
+                    cmp = rem[j + 1] > d[j] ? 1 : -1;
+                }
+            }
+            if (cmp < 0) {
+                break;
+            }
+            int64_t borrow = 0;
+            for (size_t j = dn + 1; j > 0; j--) {
+                int64_t diff = rem[j - 1] - borrow - (j > 1 ? d[j - 2] : 0);
+                borrow = diff < 0;
+                rem[j - 1] = borrow ? diff + 10 : diff;
+            }
+            digit++;
+        }
+        q[i] = digit;
+    }
+
+    memcpy(r, rem + 1, dn * sizeof(int64_t));
+    free(rem);
+}
+
+bigint bigint_divmod(bigint numerator, bigint denominator, bigint *remainder);
+
+// floor(n / 10^k) for a nonnegative n, as a new bigint
+bigint bigint_digits_truncate(bigint n, size_t k) {
+    if (k >= n.size) {
+        return bigint_zero();
+    }
+    bigint result;
+    result.is_negative = n.is_negative;
+    result.size = n.size - k;
+    result.digits = malloc(result.size * sizeof(int64_t));
+    memcpy(result.digits, n.digits, result.size * sizeof(int64_t));
     return result;
 }
 
-bigint bigint_mod(bigint a, bigint b) {
-    if (bigint_is_64_bit(a) && bigint_is_64_bit(b)) {
-        bigint result = bigint_from_int(bigint_to_int(a) % bigint_to_int(b));
-        // printf("Computing %lld %% %lld = %lld\n", bigint_to_int(a), bigint_to_int(b), bigint_to_int(result));
-        return result;
+// n * 10^k, as a new bigint
+bigint bigint_digits_scale(bigint n, size_t k) {
+    bigint result;
+    result.is_negative = n.is_negative;
+    result.size = n.size + k;
+    result.digits = calloc(result.size, sizeof(int64_t));
+    memcpy(result.digits, n.digits, n.size * sizeof(int64_t));
+    return result;
+}
+
+// 10^k, as a new bigint
+bigint bigint_digits_power(size_t k) {
+    bigint result;
+    result.is_negative = false;
+    result.size = k + 1;
+    result.digits = calloc(result.size, sizeof(int64_t));
+    result.digits[0] = 1;
+    return result;
+}
+
+/* Approximate the reciprocal of a positive, normalized bigint
+* Each Newton step x + x * (10^(2h) - d x) / 10^(2h) doubles the number of
+* correct digits, so the work is dominated by the last two products.
+* @param d The divisor
+* @param h The number of leading digits of d to use, padding d with zeros if it is shorter
+* @return A new bigint within a few units of 10^(2h) / d_h, where d_h is the leading h digits of d
+*/
+bigint bigint_reciprocal(bigint d, size_t h) {
+    // The leading digits are borrowed from d unless d needs padding
+    bool padded = h > d.size;
+    bigint d_h = padded ? bigint_digits_scale(d, h - d.size) : bigint_from_view(bigint_view_slice(bigint_view_of(d), d.size - h, h));
+    bigint power = bigint_digits_power(2 * h);
+    bigint result;
+    if (h <= 32) {
+        // Schoolbook division, since bigint_divmod would come back here under a low threshold
+        result.is_negative = false;
+        result.size = power.size;
+        result.digits = malloc(result.size * sizeof(int64_t));
+        int64_t *remainder = malloc(d_h.size * sizeof(int64_t));
+        bigint_digits_divmod(power.digits, power.size, d_h.digits, d_h.size, result.digits, remainder);
+        free(remainder);
+        bigint_remove_leading_zeros(&result);
+    } else {
+        size_t l = h / 2 + 2;
+        bigint x = bigint_reciprocal(d, l);
+        bigint x0 = bigint_digits_scale(x, h - l);
+        bigint_delete(x);
+
+        bigint product = bigint_mul(d_h, x0);
+        bigint error = bigint_sub(power, product);
+        bigint_delete(product);
+        bigint_normalize(&error);
+        bigint correction = bigint_mul(x0, error);
+        bigint_delete(error);
+        bigint_normalize(&correction);
+        bigint scaled = bigint_from_view(bigint_view_slice(bigint_view_of(correction), 2 * h, correction.size));
+        result = bigint_add(x0, scaled);
+        bigint_delete(correction);
+        bigint_delete(x0);
+    }
+    bigint_delete(power);
+    if (padded) {
+        bigint_delete(d_h);
+    }
+    return result;
+}
+
+// Divide positive, normalized bigints with a Newton reciprocal of the divisor
+bigint bigint_divmod_newton(bigint n, bigint d, bigint *remainder) {
+    size_t m = d.size, h = n.size - m + 3;
+
+    // x is about 10^(h + m) / d, so q is about n x / 10^(h + m)
+    bigint x = bigint_reciprocal(d, h);
+    bigint top = h <= m ? bigint_from_view(bigint_view_slice(bigint_view_of(n), m - h, n.size)) : bigint_digits_scale(n, h - m);
+    bigint product = bigint_mul(top, x);
+    if (h > m) {
+        bigint_delete(top);
+    }
+    bigint_delete(x);
+    bigint_normalize(&product);
+    bigint q = bigint_digits_truncate(product, 2 * h);
+    bigint_delete(product);
+
+    // The estimate is off by at most a few units
+    product = bigint_mul(q, d);
+    bigint r = bigint_sub(n, product);
+    bigint_delete(product);
+    bigint_normalize(&r);
+    bigint tmp;
+    while (bigint_ltzero(r)) {
+        tmp = r;
+        r = bigint_add(r, d);
+        bigint_delete(tmp);
+        bigint_sub_ui_inplace(&q, 1);
+    }
+    while (bigint_ge(r, d)) {
+        tmp = r;
+        r = bigint_sub(r, d);
+        bigint_delete(tmp);
+        bigint_add_ui_inplace(&q, 1);
+    }
+    bigint_normalize(&r);
+    bigint_normalize(&q);
+    *remainder = r;
+    return q;
+}
+
+bigint bigint_divmod(bigint numerator, bigint denominator, bigint *remainder) {
+    if (bigint_is_64_bit(numerator) && bigint_is_64_bit(denominator)) {
+        int64_t quotient = bigint_to_int(numerator) / bigint_to_int(denominator);
+        int64_t rem = bigint_to_int(numerator) % bigint_to_int(denominator);
+        *remainder = bigint_from_int(rem);
+        return bigint_from_int(quotient);
+    }
+
+    assert(!bigint_eqzero(denominator));
+    bool negative = numerator.is_negative != denominator.is_negative;
+
+    // Skip leading zeros without modifying the operands
+    numerator = bigint_trimmed(numerator);
+    denominator = bigint_trimmed(denominator);
+
+    bigint quotient;
+    if (denominator.size >= bigint_thresholds.newton_div && numerator.size >= denominator.size + bigint_thresholds.newton_div) {
+        numerator.is_negative = false;
+        denominator.is_negative = false;
+        quotient = bigint_divmod_newton(numerator, denominator, remainder);
+        quotient.is_negative = negative;
+        remainder->is_negative = negative;
+        return quotient;
+    }
+    quotient.size = numerator.size;
+    quotient.digits = malloc(quotient.size * sizeof(int64_t));
+    remainder->size = denominator.size;
+    remainder->digits = malloc(remainder->size * sizeof(int64_t));
+    bigint_digits_divmod(numerator.digits, numerator.size, denominator.digits, denominator.size, quotient.digits, remainder->digits);
+
+    bigint_remove_leading_zeros(&quotient);
+    bigint_remove_leading_zeros(remainder);
+
+    quotient.is_negative = negative;
+    remainder->is_negative = negative;
+
+    return quotient;
+}
+
+bigint bigint_div(bigint a, bigint b) {
+    if (bigint_is_64_bit(a) && bigint_is_64_bit(b)) {
+        return bigint_from_int(bigint_to_int(a) / bigint_to_int(b));
+    }
+
+    bigint remainder;
+    bigint result = bigint_divmod(a, b, &remainder);
+    bigint_delete(remainder);
+    return result;
+}
+
+bigint bigint_mod(bigint a, bigint b) {
+    if (bigint_is_64_bit(a) && bigint_is_64_bit(b)) {
+        bigint result = bigint_from_int(bigint_to_int(a) % bigint_to_int(b));
+        // printf("Computing %lld %% %lld = %lld\n", bigint_to_int(a), bigint_to_int(b), bigint_to_int(result));
+        return result;
+    }
+
+    bigint remainder;
+    bigint_delete(bigint_divmod(a, b, &remainder));
+    return remainder;
+}
+
+/* Bitwise operations
+* Digits are stored in base 10, so short shifts work in passes of up to
+* BIGINT_SHIFT_PASS bits over the digits. Longer ones multiply by 2^k,
+* or by 5^k and drop k digits, since n / 2^k = n * 5^k / 10^k. Bit k
+* only depends on the low k + 1 digits, since 2^(k + 1) divides
+* 10^(k + 1). Operations that need arbitrary bits convert to and from
+* 32-bit words, which is quadratic for small values and O(M(n) log n)
+* above bigint_thresholds.to_words_dc and from_words_dc digits, for
+* multiplication time M(n). Negative values behave as infinite two's
+* complement, like the C operators on signed integers.
+*/
+
+// The most bits a single shift pass can move: 10 * 2^59 still fits in an int64_t
+#define BIGINT_SHIFT_PASS 59
+
+// Above this many bits, shifts multiply or divide by a power of two instead of making passes
+#ifndef BIGINT_SHIFT_MUL_BITS
+#define BIGINT_SHIFT_MUL_BITS 2048
+#endif
+
+// base^k for a small base, as a new bigint, by repeated squaring
+bigint bigint_pow_ui(uint32_t base, size_t k) {
+    bigint result = bigint_from_int(1);
+    if (k == 0) {
+        return result;
+    }
+    size_t top = sizeof(size_t) * 8 - 1;
+    while (!(k >> top & 1)) {
+        top--;
+    }
+    for (size_t bit = top + 1; bit-- > 0;) {
+        if (result.size > 1 || result.digits[0] != 1) {
+            bigint square = bigint_mul(result, result);
+            bigint_delete(result);
+            result = square;
+        }
+        if (k >> bit & 1) {
+            bigint_mul_ui_inplace(&result, base);
+        }
+    }
+    return result;
+}
+
+// floor(|n| / 2^bits) = floor(|n| * 5^bits / 10^bits), given 5^bits, setting *inexact if that dropped a nonzero part
+bigint bigint_div_pow2(bigint n, bigint power5, size_t bits, bool *inexact) {
+    n = bigint_trimmed(n);
+    n.is_negative = false;
+    bigint product = bigint_mul(n, power5);
+    size_t keep = product.size > bits ? product.size - bits : 0;
+    *inexact = false;
+    for (size_t i = keep; i < product.size; i++) {
+        if (product.digits[i] != 0) {
+            *inexact = true;
+            break;
+        }
+    }
+    if (keep == 0) {
+        product.digits[0] = 0;
+        keep = 1;
+    }
+    product.size = keep;
+    bigint_remove_leading_zeros(&product);
+    return product;
+}
+
+/* Shift a bigint left in place
+* Costs O(n * bits) in passes up to BIGINT_SHIFT_MUL_BITS, and one
+* multiplication by 2^bits above that.
+* @param n The bigint to shift
+* @param bits The number of bits to shift by
+* @return The shifted value, n * 2^bits
+*/
+bigint bigint_shl_inplace(bigint *n, size_t bits) {
+    if (bits > BIGINT_SHIFT_MUL_BITS) {
+        bigint power = bigint_pow_ui(2, bits);
+        bigint product = bigint_mul(*n, power);
+        bigint_delete(power);
+        bigint_delete(*n);
+        *n = product;
+        return *n;
+    }
+    while (bits > 0) {
+        size_t k = bits < BIGINT_SHIFT_PASS ? bits : BIGINT_SHIFT_PASS;
+        int64_t factor = (int64_t)1 << k;
+
+        // 2^59 < 10^18, so each pass adds at most 18 digits
+        size_t extra = 18;
+        n->digits = realloc(n->digits, (n->size + extra) * sizeof(int64_t));
+        memmove(n->digits + extra, n->digits, n->size * sizeof(int64_t));
+        memset(n->digits, 0, extra * sizeof(int64_t));
+        n->size += extra;
+
+        int64_t carry = 0;
+        for (size_t i = n->size; i > 0; i--) {
+            int64_t value = n->digits[i - 1] * factor + carry;
+            n->digits[i - 1] = value % 10;
+            carry = value / 10;
+        }
+        bigint_remove_leading_zeros(n);
+        bits -= k;
+    }
+    return *n;
+}
+
+/* Shift a bigint right in place
+* Rounds toward negative infinity, like an arithmetic shift. Costs
+* O(n * bits) in passes up to BIGINT_SHIFT_MUL_BITS, and one
+* multiplication by 5^bits above that.
+* @param n The bigint to shift
+* @param bits The number of bits to shift by
+* @return The shifted value, floor(n / 2^bits)
+*/
+bigint bigint_shr_inplace(bigint *n, size_t bits) {
+    if (bits > BIGINT_SHIFT_MUL_BITS) {
+        bool negative = bigint_ltzero(*n), inexact;
+        bigint power = bigint_pow_ui(5, bits);
+        bigint quotient = bigint_div_pow2(*n, power, bits, &inexact);
+        if (negative && inexact) {
+            // Round the magnitude up, toward negative infinity
+            bigint_add_ui_inplace(&quotient, 1);
+        }
+        quotient.is_negative = negative && !bigint_eqzero(quotient);
+        bigint_delete(power);
+        bigint_delete(*n);
+        *n = quotient;
+        return *n;
+    }
+    bool inexact = false;
+    while (bits > 0 && !(n->size == 1 && n->digits[0] == 0)) {
+        size_t k = bits < BIGINT_SHIFT_PASS ? bits : BIGINT_SHIFT_PASS;
+        int64_t mask = ((int64_t)1 << k) - 1;
+        int64_t rem = 0;
+        for (size_t i = 0; i < n->size; i++) {
+            int64_t value = rem * 10 + n->digits[i];
+            n->digits[i] = value >> k;
+            rem = value & mask;
+        }
+        inexact |= rem != 0;
+        bigint_remove_leading_zeros(n);
+        bits -= k;
+    }
+    if (n->is_negative && inexact) {
+        // Round the magnitude up, toward negative infinity
+        size_t i = n->size;
+        while (i > 0 && n->digits[i - 1] == 9) {
+            n->digits[--i] = 0;
+        }
+        if (i > 0) {
+            n->digits[i - 1]++;
+        } else {
+            n->digits = realloc(n->digits, (n->size + 1) * sizeof(int64_t));
+            memmove(n->digits + 1, n->digits, n->size * sizeof(int64_t));
+            n->digits[0] = 1;
+            n->size++;
+        }
+    }
+    if (n->size == 1 && n->digits[0] == 0) {
+        n->is_negative = false;
+    }
+    return *n;
+}
+
+/* Shift a bigint left
+* @param n The bigint to shift
+* @param bits The number of bits to shift by
+* @return A new bigint with the value n * 2^bits
+*/
+bigint bigint_shl(bigint n, size_t bits) {
+    bigint result = bigint_copy(n);
+    return bigint_shl_inplace(&result, bits);
+}
+
+/* Shift a bigint right
+* @param n The bigint to shift
+* @param bits The number of bits to shift by
+* @return A new bigint with the value floor(n / 2^bits)
+*/
+bigint bigint_shr(bigint n, size_t bits) {
+    bigint result = bigint_copy(n);
+    return bigint_shr_inplace(&result, bits);
+}
+
+// Convert a magnitude to words with Horner's rule into zeroed words, returning the count
+size_t bigint_words_basecase(bigint n, uint32_t *words) {
+    size_t count = 0;
+
+    // Horner's rule over chunks of up to 9 decimal digits
+    size_t i = 0;
+    while (i < n.size) {
+        size_t len = (n.size - i) % 9 ? (n.size - i) % 9 : 9;
+        uint64_t carry = 0, scale = 1;
+        for (size_t j = 0; j < len; j++) {
+            carry = carry * 10 + n.digits[i + j];
+            scale *= 10;
+        }
+        for (size_t w = 0; w < count; w++) {
+            uint64_t value = (uint64_t)words[w] * scale + carry;
+            words[w] = (uint32_t)value;
+            carry = value >> 32;
+        }
+        while (carry > 0) {
+            words[count++] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        i += len;
+    }
+    return count;
+}
+
+// The split of the radix conversions at a depth, in words: ceil(count / 2^(depth + 1))
+size_t bigint_word_split(size_t count, size_t depth) {
+    return (count >> (depth + 1)) + ((count & (((size_t)2 << depth) - 1)) != 0);
+}
+
+// The number of depths at which values of up to count words are split, down to threshold digits
+size_t bigint_word_levels(size_t count, size_t threshold) {
+    size_t levels = 0;
+    // Each word holds a little over 9.6 decimal digits
+    while (levels < sizeof(size_t) * 8 - 2 && bigint_word_split(count, levels) > 1 &&
+           bigint_word_split(count, levels) * 2 * 963 / 100 >= threshold) {
+        levels++;
+    }
+    return levels;
+}
+
+// Powers base^(32 * split) for the split at each depth, as new bigints
+bigint *bigint_word_powers(uint32_t base, size_t count, size_t levels) {
+    bigint *powers = malloc(levels * sizeof(bigint));
+    for (size_t depth = levels; depth-- > 0;) {
+        size_t split = bigint_word_split(count, depth);
+        if (depth + 1 < levels && split == 2 * bigint_word_split(count, depth + 1)) {
+            powers[depth] = bigint_mul(powers[depth + 1], powers[depth + 1]);
+        } else {
+            powers[depth] = bigint_pow_ui(base, 32 * split);
+        }
+    }
+    return powers;
+}
+
+void bigint_word_powers_delete(bigint *powers, size_t levels) {
+    for (size_t i = 0; i < levels; i++) {
+        bigint_delete(powers[i]);
+    }
+    free(powers);
+}
+
+// Write the words of a magnitude at a depth of the split of count words into zeroed words
+void bigint_words_dc(bigint n, const bigint *powers2, const bigint *powers5, size_t count, size_t depth, size_t levels, uint32_t *words) {
+    n = bigint_trimmed(n);
+    if (depth == levels || n.size < bigint_thresholds.to_words_dc) {
+        bigint_words_basecase(n, words);
+        return;
+    }
+    // n = high * 2^(32 * split) + low
+    size_t split = bigint_word_split(count, depth);
+    bool inexact;
+    bigint high = bigint_div_pow2(n, powers5[depth], 32 * split, &inexact);
+    bigint product = bigint_mul(high, powers2[depth]);
+    bigint low = bigint_sub(n, product);
+    bigint_words_dc(low, powers2, powers5, count, depth + 1, levels, words);
+    bigint_words_dc(high, powers2, powers5, count, depth + 1, levels, words + split);
+    bigint_delete(high);
+    bigint_delete(product);
+    bigint_delete(low);
+}
+
+/* Convert the magnitude of a bigint to 32-bit words
+* Above bigint_thresholds.to_words_dc digits, the magnitude is split in
+* half by a power 2^(32 * k) and the halves are converted recursively.
+* Each split multiplies by 5^(32 * k) and drops as many decimal digits
+* instead of dividing, for O(M(n) log n) in all.
+* @param n The bigint to convert
+* @param count Set to the number of words, with no leading zero words
+* @return A new array of the words, least significant first, to be freed by the caller
+*/
+uint32_t *bigint_to_words(bigint n, size_t *count) {
+    n = bigint_trimmed(n);
+    n.is_negative = false;
+    // log2(10) < 3.33, plus room for the final carry
+    size_t capacity = n.size * 333 / 3200 + 2;
+    uint32_t *words = calloc(capacity, sizeof(uint32_t));
+    size_t levels = bigint_word_levels(capacity, bigint_thresholds.to_words_dc);
+    if (n.size < bigint_thresholds.to_words_dc || levels == 0) {
+        *count = bigint_words_basecase(n, words);
+        return words;
+    }
+
+    bigint *powers2 = bigint_word_powers(2, capacity, levels), *powers5 = bigint_word_powers(5, capacity, levels);
+    bigint_words_dc(n, powers2, powers5, capacity, 0, levels, words);
+    bigint_word_powers_delete(powers2, levels);
+    bigint_word_powers_delete(powers5, levels);
+    *count = capacity;
+    while (*count > 0 && words[*count - 1] == 0) {
+        (*count)--;
+    }
+    return words;
+}
+
+// Convert nonzero words with no leading zero word to a magnitude by repeated division
+bigint bigint_from_words_basecase(const uint32_t *words, size_t count) {
+    // Repeatedly divide by 10^9, collecting the remainders
+    uint32_t *work = malloc(count * sizeof(uint32_t));
+    memcpy(work, words, count * sizeof(uint32_t));
+    size_t chunk_count = 0;
+    uint32_t *chunks = malloc((count * 32 / 29 + 2) * sizeof(uint32_t));
+    while (count > 0) {
+        uint64_t rem = 0;
+        for (size_t w = count; w > 0; w--) {
+            uint64_t value = (rem << 32) | work[w - 1];
+            work[w - 1] = (uint32_t)(value / 1000000000);
+            rem = value % 1000000000;
+        }
+        chunks[chunk_count++] = (uint32_t)rem;
+        while (count > 0 && work[count - 1] == 0) {
+            count--;
+        }
+    }
+    free(work);
+
+    bigint result;
+    result.is_negative = false;
+    result.size = chunk_count * 9;
+    result.digits = malloc(result.size * sizeof(int64_t));
+    for (size_t c = 0; c < chunk_count; c++) {
+        uint32_t chunk = chunks[c];
+        for (size_t j = 0; j < 9; j++) {
+            result.digits[result.size - c * 9 - j - 1] = chunk % 10;
+            chunk /= 10;
+        }
+    }
+    free(chunks);
+    bigint_remove_leading_zeros(&result);
+    return result;
+}
+
+// Convert the words at a depth of the split of total words to a magnitude
+bigint bigint_from_words_dc(const uint32_t *words, size_t count, const bigint *powers, size_t total, size_t depth, size_t levels) {
+    while (count > 0 && words[count - 1] == 0) {
+        count--;
+    }
+    if (count == 0) {
+        return bigint_zero();
+    }
+    if (depth == levels || count * 963 / 100 < bigint_thresholds.from_words_dc) {
+        return bigint_from_words_basecase(words, count);
+    }
+    size_t split = bigint_word_split(total, depth);
+    if (count <= split) {
+        return bigint_from_words_dc(words, count, powers, total, depth + 1, levels);
+    }
+    bigint high = bigint_from_words_dc(words + split, count - split, powers, total, depth + 1, levels);
+    bigint low = bigint_from_words_dc(words, split, powers, total, depth + 1, levels);
+    bigint product = bigint_mul(high, powers[depth]);
+    bigint result = bigint_add(product, low);
+    bigint_delete(high);
+    bigint_delete(low);
+    bigint_delete(product);
+    return result;
+}
+
+/* Create a bigint from 32-bit words
+* Above bigint_thresholds.from_words_dc digits, the high and low halves are
+* converted recursively and joined with one multiplication, for
+* O(M(n) log n) in all.
+* @param words The words of the magnitude, least significant first
+* @param count The number of words
+* @param is_negative The sign of the result
+* @return A new bigint with the value of the words
+*/
+bigint bigint_from_words(const uint32_t *words, size_t count, bool is_negative) {
+    while (count > 0 && words[count - 1] == 0) {
+        count--;
+    }
+    if (count == 0) {
+        return bigint_zero();
+    }
+    size_t levels = bigint_word_levels(count, bigint_thresholds.from_words_dc);
+    bigint result;
+    if (levels == 0) {
+        result = bigint_from_words_basecase(words, count);
+    } else {
+        bigint *powers = bigint_word_powers(2, count, levels);
+        result = bigint_from_words_dc(words, count, powers, count, 0, levels);
+        bigint_word_powers_delete(powers, levels);
+    }
+    result.is_negative = is_negative;
+    return result;
+}
+
+// Write the two's complement of a magnitude, sign extended to count words
+void bigint_to_twos_words(const uint32_t *magnitude, size_t magnitude_count, bool is_negative, uint32_t *out, size_t count) {
+    for (size_t w = 0; w < count; w++) {
+        out[w] = w < magnitude_count ? magnitude[w] : 0;
+    }
+    if (is_negative) {
+        uint64_t carry = 1;
+        for (size_t w = 0; w < count; w++) {
+            uint64_t value = (uint64_t)(uint32_t)~out[w] + carry;
+            out[w] = (uint32_t)value;
+            carry = value >> 32;
+        }
+    }
+}
+
+// Create a bigint from sign-extended two's complement words, which are overwritten
+bigint bigint_from_twos_words(uint32_t *words, size_t count) {
+    bool negative = count > 0 && (words[count - 1] >> 31);
+    if (negative) {
+        uint64_t carry = 1;
+        for (size_t w = 0; w < count; w++) {
+            uint64_t value = (uint64_t)(uint32_t)~words[w] + carry;
+            words[w] = (uint32_t)value;
+            carry = value >> 32;
+        }
+    }
+    return bigint_from_words(words, count, negative);
+}
+
+typedef enum {
+    BIGINT_BIT_AND,
+    BIGINT_BIT_OR,
+    BIGINT_BIT_XOR,
+} bigint_bit_op;
+
+bigint bigint_bitwise(bigint_bit_op op, bigint a, bigint b) {
+    size_t an, bn;
+    uint32_t *am = bigint_to_words(a, &an);
+    uint32_t *bm = bigint_to_words(b, &bn);
+    size_t count = (an > bn ? an : bn) + 1;
+    uint32_t *aw = malloc(2 * count * sizeof(uint32_t));
+    uint32_t *bw = aw + count;
+    bigint_to_twos_words(am, an, bigint_ltzero(a), aw, count);
+    bigint_to_twos_words(bm, bn, bigint_ltzero(b), bw, count);
+    free(am);
+    free(bm);
+    for (size_t w = 0; w < count; w++) {
+        switch (op) {
+        case BIGINT_BIT_AND:
+            aw[w] &= bw[w];
+            break;
+        case BIGINT_BIT_OR:
+            aw[w] |= bw[w];
+            break;
+        case BIGINT_BIT_XOR:
+            aw[w] ^= bw[w];
+            break;
+        }
+    }
+    bigint result = bigint_from_twos_words(aw, count);
+    free(aw);
+    return result;
+}
+
+/* Bitwise and of two bigints
+* @param a The first bigint
+* @param b The second bigint
+* @return A new bigint with the value a & b
+*/
+bigint bigint_and(bigint a, bigint b) {
+    return bigint_bitwise(BIGINT_BIT_AND, a, b);
+}
+
+/* Bitwise or of two bigints
+* @param a The first bigint
+* @param b The second bigint
+* @return A new bigint with the value a | b
+*/
+bigint bigint_or(bigint a, bigint b) {
+    return bigint_bitwise(BIGINT_BIT_OR, a, b);
+}
+
+/* Bitwise exclusive or of two bigints
+* @param a The first bigint
+* @param b The second bigint
+* @return A new bigint with the value a ^ b
+*/
+bigint bigint_xor(bigint a, bigint b) {
+    return bigint_bitwise(BIGINT_BIT_XOR, a, b);
+}
+
+/* Bitwise complement of a bigint
+* @param n The bigint to complement
+* @return A new bigint with the value ~n = -n - 1
+*/
+bigint bigint_not(bigint n) {
+    bigint result = bigint_copy(n);
+    result.is_negative = !result.is_negative;
+    return bigint_sub_ui_inplace(&result, 1);
+}
+
+bigint bigint_not_inplace(bigint *n) {
+    bigint tmp = *n;
+    *n = bigint_not(*n);
+    bigint_delete(tmp);
+    return *n;
+}
+
+bigint bigint_and_inplace(bigint *a, bigint b) {
+    bigint tmp = *a;
+    *a = bigint_and(*a, b);
+    bigint_delete(tmp);
+    return *a;
+}
+
+bigint bigint_or_inplace(bigint *a, bigint b) {
+    bigint tmp = *a;
+    *a = bigint_or(*a, b);
+    bigint_delete(tmp);
+    return *a;
+}
+
+bigint bigint_xor_inplace(bigint *a, bigint b) {
+    bigint tmp = *a;
+    *a = bigint_xor(*a, b);
+    bigint_delete(tmp);
+    return *a;
+}
+
+/* Test a bit of a bigint
+* Only the low bit + 1 digits are read and shifted right, so the cost
+* depends on the bit's index and not on the size of n.
+* @param n The bigint to test
+* @param bit The index of the bit, counting from the least significant
+* @return Whether the bit is set in the two's complement of n
+*/
+bool bigint_testbit(bigint n, size_t bit) {
+    n = bigint_trimmed(n);
+    bool negative = bigint_ltzero(n);
+    // |n| < 10^size < 2^(size * 10 / 3 + 1), so higher bits are all sign bits
+    if (bit >= n.size * 10 / 3 + 1) {
+        return negative;
+    }
+
+    // |n| mod 10^(bit + 1) has the same low bit + 1 bits as |n|
+    size_t low = bit + 1 < n.size ? bit + 1 : n.size;
+    bigint digits = bigint_copy(bigint_from_view(bigint_view_slice(bigint_view_of(n), 0, low)));
+    digits.is_negative = false;
+    bigint_remove_leading_zeros(&digits);
+    if (negative) {
+        // The bits of -m are the complements of the bits of m - 1
+        if (bigint_eqzero(digits)) {
+            bigint_delete(digits);
+            return false;
+        }
+        bigint_sub_ui_inplace(&digits, 1);
+    }
+    bigint_shr_inplace(&digits, bit);
+    bool set = digits.digits[digits.size - 1] % 2 == 1;
+    bigint_delete(digits);
+    return set != negative;
+}
+
+/* Set a bit of a bigint in place
+* @param n The bigint to modify
+* @param bit The index of the bit to set
+* @return The modified value
+*/
+bigint bigint_setbit(bigint *n, size_t bit) {
+    if (bigint_testbit(*n, bit)) {
+        return *n;
+    }
+    bigint power = bigint_pow_ui(2, bit), tmp = *n;
+    *n = bigint_add(*n, power);
+    bigint_delete(tmp);
+    bigint_delete(power);
+    return *n;
+}
+
+/* Clear a bit of a bigint in place
+* @param n The bigint to modify
+* @param bit The index of the bit to clear
+* @return The modified value
+*/
+bigint bigint_clrbit(bigint *n, size_t bit) {
+    if (!bigint_testbit(*n, bit)) {
+        return *n;
+    }
+    bigint power = bigint_pow_ui(2, bit), tmp = *n;
+    *n = bigint_sub(*n, power);
+    bigint_delete(tmp);
+    bigint_delete(power);
+    return *n;
+}
+
+/* Count the bits in the magnitude of a bigint
+* @param n The bigint to measure
+* @return The number of bits needed to represent |n|, 0 for zero
+*/
+size_t bigint_bit_length(bigint n) {
+    size_t count;
+    uint32_t *words = bigint_to_words(n, &count);
+    size_t result = 0;
+    if (count > 0) {
+        uint32_t top = words[count - 1];
+        result = (count - 1) * 32;
+        while (top > 0) {
+            result++;
+            top >>= 1;
+        }
+    }
+    free(words);
+    return result;
+}
+
+/* Count the set bits of a bigint
+* @param n The bigint to count
+* @return The number of set bits, or SIZE_MAX for negative n
+*/
+size_t bigint_popcount(bigint n) {
+    if (bigint_ltzero(n)) {
+        return SIZE_MAX;
+    }
+    size_t count, result = 0;
+    uint32_t *words = bigint_to_words(n, &count);
+    for (size_t w = 0; w < count; w++) {
+        uint32_t word = words[w];
+        while (word > 0) {
+            word &= word - 1;
+            result++;
+        }
+    }
+    free(words);
+    return result;
+}
+
+/* Find the first set bit at or after a position
+* @param n The bigint to scan
+* @param start The bit index to start from
+* @return The index of the first set bit in the two's complement of n,
+* or SIZE_MAX if there is none
+*/
+size_t bigint_scan1(bigint n, size_t start) {
+    size_t magnitude_count;
+    uint32_t *magnitude = bigint_to_words(n, &magnitude_count);
+    size_t count = magnitude_count + 1;
+    uint32_t *words = malloc(count * sizeof(uint32_t));
+    bigint_to_twos_words(magnitude, magnitude_count, bigint_ltzero(n), words, count);
+    free(magnitude);
+    size_t result = SIZE_MAX;
+    for (size_t w = start / 32; w < count; w++) {
+        uint32_t word = words[w];
+        if (w == start / 32) {
+            word &= ~(uint32_t)0 << (start % 32);
+        }
+        if (word != 0) {
+            result = w * 32;
+            while (!(word & 1)) {
+                word >>= 1;
+                result++;
+            }
+            break;
+        }
+    }
+    // Negative values have infinitely many set bits above their words
+    if (result == SIZE_MAX && bigint_ltzero(n)) {
+        result = start > count * 32 ? start : count * 32;
+    }
+    free(words);
+    return result;
+}
+
+/* Exact division
+* Quotients known to be exact are found from the low digits up (Hensel
+* division in base 10), so no quotient digit has to be estimated or
+* corrected. Base 10 is not prime, so factors of 2 and 5 in the divisor
+* are removed first, leaving a divisor whose last digit is invertible.
+*/
+
+// Copy the last count digits of |n|
+bigint bigint_low_digits(bigint n, size_t count) {
+    bigint result;
+    result.is_negative = false;
+    if (count >= n.size) {
+        result = bigint_copy(n);
+        result.is_negative = false;
+        return result;
+    }
+    result.size = count;
+    result.digits = malloc(count * sizeof(int64_t));
+    memcpy(result.digits, n.digits + n.size - count, count * sizeof(int64_t));
+    bigint_normalize(&result);
+    return result;
+}
+
+// The number of factors of a prime, 2 or 5, in |n|, which must not end in a zero
+size_t bigint_valuation_2_5(bigint n, uint64_t prime) {
+    // prime^m divides 10^m, so a count below m only depends on the last m digits
+    for (size_t m = 64;; m *= 2) {
+        bigint low = bigint_low_digits(n, m);
+        size_t count = 0;
+        if (prime == 2) {
+            count = bigint_scan1(low, 0);
+        } else {
+            // 5^25 < UINT64_MAX / 10
+            const uint64_t chunk = 298023223876953125u;
+            uint64_t rem;
+            while ((rem = bigint_mod_ui(low, chunk)) == 0) {
+                bigint_divmod_ui_inplace(&low, chunk);
+                count += 25;
+            }
+            for (; rem % 5 == 0; rem /= 5) {
+                count++;
+            }
+        }
+        bigint_delete(low);
+        if (count < m || m >= n.size) {
+            return count;
+        }
+    }
+}
+
+// Divide |n| in place by 5^count, which must divide it exactly, as n * 2^count / 10^count
+void bigint_div_5_pow(bigint *n, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    bool inexact;
+    bigint power = bigint_pow_ui(2, count);
+    bigint quotient = bigint_div_pow2(*n, power, count, &inexact);
+    assert(!inexact);
+    (void)inexact;
+    bigint_delete(power);
+    bigint_delete(*n);
+    *n = quotient;
+}
+
+/* Remove the factors of 10, 2 and 5 from |d| in place, counting them
+* Trailing zeros are dropped without touching the other digits, and what
+* is left has factors of 2 or of 5 but not both, each removed at once.
+* @param d The nonzero bigint to reduce
+* @param tens Set to the number of factors of 10
+* @param twos Set to the number of further factors of 2
+* @param fives Set to the number of further factors of 5
+*/
+void bigint_remove_2_5(bigint *d, size_t *tens, size_t *twos, size_t *fives) {
+    *tens = 0;
+    while (*tens + 1 < d->size && d->digits[d->size - *tens - 1] == 0) {
+        (*tens)++;
+    }
+    d->size -= *tens;
+    *twos = 0;
+    *fives = 0;
+    if (d->digits[d->size - 1] % 2 == 0) {
+        *twos = bigint_valuation_2_5(*d, 2);
+        bigint_shr_inplace(d, *twos);
+    } else if (d->digits[d->size - 1] == 5) {
+        *fives = bigint_valuation_2_5(*d, 5);
+        bigint_div_5_pow(d, *fives);
+    }
+}
+
+// The inverse of an odd digit other than 5, modulo 10
+int64_t bigint_digit_inverse(int64_t digit) {
+    static const int64_t inverses[10] = {0, 1, 0, 7, 0, 0, 0, 3, 0, 9};
+    return inverses[digit];
+}
+
+/* Hensel division of digits, modulo 10^qn
+* @param a The little-endian digits of the dividend, at least qn of them, overwritten
+* @param d The little-endian digits of a divisor coprime to 10
+* @param dn The number of divisor digits
+* @param q The output little-endian quotient digits
+* @param qn The number of quotient digits to find
+*/
+void bigint_digits_divexact(int64_t *a, const int64_t *d, size_t dn, int64_t *q, size_t qn) {
+    int64_t inverse = bigint_digit_inverse(d[0]);
+    for (size_t i = 0; i < qn; i++) {
+        int64_t digit = a[i] * inverse % 10;
+        q[i] = digit;
+        if (digit == 0) {
+            continue;
+        }
+        int64_t borrow = 0;
+        for (size_t j = 0; i + j < qn && (j < dn || borrow); j++) {
+            int64_t diff = a[i + j] - borrow - (j < dn ? digit * d[j] : 0);
+            borrow = 0;
+            if (diff < 0) {
+                borrow = (9 - diff) / 10;
+                diff += borrow * 10;
+            }
+            a[i + j] = diff;
+        }
+    }
+}
+
+/* Find the inverse of a bigint modulo a power of 10 by Newton's iteration
+* @param d The bigint to invert, coprime to 10
+* @param count The number of digits of the inverse
+* @return A new bigint x with d * x = 1 mod 10^count
+*/
+bigint bigint_inverse_mod_10_pow(bigint d, size_t count) {
+    bigint x = bigint_from_int(bigint_digit_inverse(d.digits[d.size - 1]));
+    size_t precision = 1;
+    while (precision < count) {
+        precision = 2 * precision < count ? 2 * precision : count;
+
+        // x = x * (2 - d * x) mod 10^precision
+        bigint low = bigint_low_digits(d, precision);
+        bigint t = bigint_mul(low, x);
+        bigint_delete(low);
+        low = bigint_low_digits(t, precision);
+        bigint_delete(t);
+
+        // 2 - d * x, taken modulo 10^precision
+        bigint correction;
+        correction.is_negative = false;
+        correction.size = precision + 1;
+        correction.digits = calloc(correction.size, sizeof(int64_t));
+        correction.digits[0] = 1;
+        bigint_add_ui_inplace(&correction, 2);
+        t = bigint_sub(correction, low);
+        bigint_delete(correction);
+        bigint_delete(low);
+
+        bigint product = bigint_mul(x, t);
+        bigint_delete(x);
+        bigint_delete(t);
+        x = bigint_low_digits(product, precision);
+        bigint_delete(product);
+    }
+    return x;
+}
+
+/* Divide two bigints when the division is known to be exact
+* @param a The dividend, which must be a multiple of d
+* @param d The nonzero divisor
+* @return A new bigint with the value a / d
+*/
+bigint bigint_divexact(bigint a, bigint d) {
+    assert(!bigint_eqzero(d));
+    bool negative = a.is_negative != d.is_negative;
+
+    size_t tens, twos, fives;
+    bigint divisor = bigint_copy(d);
+    divisor.is_negative = false;
+    bigint_normalize(&divisor);
+    bigint_remove_2_5(&divisor, &tens, &twos, &fives);
+
+    bigint dividend = bigint_copy(a);
+    dividend.is_negative = false;
+    bigint_normalize(&dividend);
+    // a is a multiple of 10^tens, so its last tens digits are zeros
+    if (dividend.size > tens) {
+        dividend.size -= tens;
+    } else {
+        dividend.size = 1;
+        dividend.digits[0] = 0;
+    }
+    bigint_shr_inplace(&dividend, twos);
+    bigint_div_5_pow(&dividend, fives);
+
+    bigint result;
+    if (dividend.size < divisor.size) {
+        // Only an exact multiple of zero is shorter than the divisor
+        result = bigint_zero();
+    } else if (dividend.size - divisor.size + 1 >= bigint_thresholds.divexact_dc && divisor.size > 1) {
+        // q = a * d^-1 mod 10^qn
+        size_t qn = dividend.size - divisor.size + 1;
+        bigint inverse = bigint_inverse_mod_10_pow(divisor, qn);
+        bigint low = bigint_low_digits(dividend, qn);
+        bigint product = bigint_mul(low, inverse);
+        result = bigint_low_digits(product, qn);
+        bigint_delete(inverse);
+        bigint_delete(low);
+        bigint_delete(product);
+    } else {
+        size_t qn = dividend.size - divisor.size + 1;
+        int64_t *work = calloc(qn + divisor.size + qn, sizeof(int64_t));
+        int64_t *d_digits = work + qn, *q_digits = d_digits + divisor.size;
+        for (size_t i = 0; i < qn; i++) {
+            work[i] = dividend.digits[dividend.size - i - 1];
+        }
+        for (size_t i = 0; i < divisor.size; i++) {
+            d_digits[i] = divisor.digits[divisor.size - i - 1];
+        }
+        bigint_digits_divexact(work, d_digits, divisor.size, q_digits, qn);
+
+        result.is_negative = false;
+        result.size = qn;
+        result.digits = malloc(qn * sizeof(int64_t));
+        for (size_t i = 0; i < qn; i++) {
+            result.digits[i] = q_digits[qn - i - 1];
+        }
+        free(work);
+    }
+    bigint_delete(dividend);
+    bigint_delete(divisor);
+
+    result.is_negative = negative;
+    bigint_normalize(&result);
+    return result;
+}
+
+// Test whether the last count digits of |n| are divisible by prime^count, for a prime 2 or 5
+bool bigint_low_digits_divisible(bigint n, uint64_t prime, size_t count) {
+    if (count == 0) {
+        return true;
+    }
+    // prime^count divides them exactly when their product with (10 / prime)^count ends in count zeros
+    bigint low = bigint_low_digits(n, count);
+    bigint power = bigint_pow_ui((uint32_t)(10 / prime), count);
+    bigint product = bigint_mul(low, power);
+    bool result = true;
+    for (size_t i = 0; i < count && i < product.size && result; i++) {
+        result = product.digits[product.size - i - 1] == 0;
+    }
+    bigint_delete(low);
+    bigint_delete(power);
+    bigint_delete(product);
+    return result;
+}
+
+/* Test whether a bigint is divisible by another
+* Below bigint_thresholds.divexact_dc quotient digits, no quotient is
+* built: only a running remainder is kept. Above it, the candidate
+* quotient from bigint_divexact is multiplied back.
+* @param a The bigint to test
+* @param d The divisor
+* @return Whether d divides a
+*/
+bool bigint_divisible_p(bigint a, bigint d) {
+    if (bigint_eqzero(d)) {
+        return bigint_eqzero(a);
+    }
+
+    // 10^k, 2^k and 5^k divide 10^k, so they only depend on the last k digits of a
+    size_t tens, twos, fives;
+    bigint divisor = bigint_copy(d);
+    divisor.is_negative = false;
+    bigint_normalize(&divisor);
+    bigint_remove_2_5(&divisor, &tens, &twos, &fives);
+    for (size_t i = 0; i < tens && i < a.size; i++) {
+        if (a.digits[a.size - i - 1] != 0) {
+            bigint_delete(divisor);
+            return false;
+        }
+    }
+    if (a.size <= tens) {
+        // Only zero has no digits left
+        bigint_delete(divisor);
+        return true;
+    }
+    a.size -= tens;
+    if (!bigint_low_digits_divisible(a, 2, twos) || !bigint_low_digits_divisible(a, 5, fives)) {
+        bigint_delete(divisor);
+        return false;
+    }
+
+    while (a.size > 1 && a.digits[0] == 0) {
+        a.digits++;
+        a.size--;
+    }
+    if (a.size < divisor.size) {
+        bigint_delete(divisor);
+        return bigint_eqzero(a);
+    }
+    if (a.size - divisor.size + 1 >= bigint_thresholds.divexact_dc && divisor.size > 1) {
+        // The divisor is now coprime to 10, so bigint_divexact has nothing left to remove
+        bigint magnitude = a;
+        magnitude.is_negative = false;
+        bigint quotient = bigint_divexact(magnitude, divisor);
+        bigint product = bigint_mul(quotient, divisor);
+        bool result = bigint_eq(product, magnitude);
+        bigint_delete(quotient);
+        bigint_delete(product);
+        bigint_delete(divisor);
+        return result;
+    }
+
+    // Clear the low digits of a with multiples of the divisor; what is left must be zero
+    size_t an = a.size, dn = divisor.size;
+    int64_t *work = calloc(an + dn, sizeof(int64_t));
+    int64_t *d_digits = work + an;
+    for (size_t i = 0; i < an; i++) {
+        work[i] = a.digits[an - i - 1];
+    }
+    for (size_t i = 0; i < dn; i++) {
+        d_digits[i] = divisor.digits[dn - i - 1];
+    }
+    bigint_delete(divisor);
+
+    int64_t inverse = bigint_digit_inverse(d_digits[0]);
+    int64_t borrow = 0;
+    for (size_t i = 0; i < an - dn + 1; i++) {
+        int64_t digit = work[i] * inverse % 10;
+        borrow = 0;
+        for (size_t j = 0; i + j < an && (j < dn || borrow); j++) {
+            int64_t diff = work[i + j] - borrow - (j < dn ? digit * d_digits[j] : 0);
+            borrow = 0;
+            if (diff < 0) {
+                borrow = (9 - diff) / 10;
+                diff += borrow * 10;
+            }
+            work[i + j] = diff;
+        }
+        if (borrow) {
+            // The multiple of d exceeded a
+            break;
+        }
+    }
+    bool result = !borrow;
+    for (size_t i = 0; result && i < an; i++) {
+        result = work[i] == 0;
+    }
+    free(work);
+    return result;
+}
+
+bigint bigint_pow(bigint a, bigint b) {
+    bigint result, tmp;
+    if (b.is_negative) {
+        result = bigint_zero();
+        return result;
+    }
+    result = bigint_copy(bigint_const_one);
+    if (bigint_eqzero(b)) {
+        return result;
+    }
+    b = bigint_copy(b);
+    while (!bigint_eqzero(b)) {
+        tmp = result;
+        result = bigint_mul(result, a);
+        bigint_delete(tmp);
+        bigint_dec(&b);
+    }
+    bigint_delete(b);
+    return result;
+}
+
+/* How a reduction context reduces */
+typedef enum {
+    // Barrett's method, for any modulus
+    BIGINT_MODCTX_BARRETT,
+    // Folding by m = 10^split - c
+    BIGINT_MODCTX_DECIMAL,
+} bigint_modctx_kind;
+
+/* A precomputed context for repeated reductions by a fixed modulus
+* Reductions use Barrett's method in base 10: two multiplications and
+* no division, for both odd and even moduli. Moduli of the special form
+* 10^split - c with a small c, such as 10^40 - 87 or 10^50 + 151, are
+* instead reduced by folding: 10^split is c mod m, so the digits of x
+* above the low split digits are multiplied by c and added to the rest.
+* Binary forms such as 2^255 - 19 have no cheap split in base 10, so they
+* use Barrett's method.
+*/
+typedef struct {
+    // The (positive) modulus
+    bigint m;
+    // floor(10^(2k) / m), for Barrett reduction
+    bigint mu;
+    // The number of digits in the modulus
+    size_t k;
+    bigint_modctx_kind kind;
+    // For the special form, m = 10^split - c, where c may be negative
+    size_t split;
+    bigint c;
+} bigint_modctx;
+
+// Use folding if m is 10^split - c with c at most half as long as m
+bool bigint_modctx_detect(bigint_modctx *ctx) {
+    if (bigint_cmp_si(ctx->m, 1) == 0) {
+        return false;
+    }
+
+    // m is just below 10^k or just above 10^(k-1)
+    for (size_t split = ctx->k - 1; split <= ctx->k; split++) {
+        bigint power;
+        power.is_negative = false;
+        power.size = split + 1;
+        power.digits = calloc(power.size, sizeof(int64_t));
+        power.digits[0] = 1;
+        bigint c = bigint_sub(power, ctx->m);
+        bigint_delete(power);
+        bigint_normalize(&c);
+        if (split > 0 && !bigint_eqzero(c) && 2 * c.size <= split) {
+            bigint_delete(ctx->c);
+            ctx->kind = BIGINT_MODCTX_DECIMAL;
+            ctx->split = split;
+            ctx->c = c;
+            return true;
+        }
+        bigint_delete(c);
+    }
+    return false;
+}
+
+/* Create a reduction context for a modulus
+* @param m The modulus, which must be positive
+* @return A new context, to be freed with bigint_modctx_delete
+*/
+bigint_modctx bigint_modctx_new(bigint m) {
+    assert(bigint_gtzero(m));
+    bigint_modctx ctx;
+    ctx.m = bigint_copy(m);
+    bigint_remove_leading_zeros(&ctx.m);
+    ctx.k = ctx.m.size;
+    ctx.kind = BIGINT_MODCTX_BARRETT;
+    ctx.split = 0;
+    ctx.c = bigint_zero();
+    if (bigint_modctx_detect(&ctx)) {
+        ctx.mu = bigint_zero();
+        return ctx;
+    }
+
+    // mu = floor(10^(2k) / m)
+    bigint power;
+    power.is_negative = false;
+    power.size = 2 * ctx.k + 1;
+    power.digits = calloc(power.size, sizeof(int64_t));
+    power.digits[0] = 1;
+    bigint remainder;
+    ctx.mu = bigint_divmod(power, ctx.m, &remainder);
+    bigint_delete(remainder);
+    bigint_delete(power);
+    return ctx;
+}
+
+/* Delete a reduction context
+* @param ctx The context to delete
+*/
+void bigint_modctx_delete(bigint_modctx ctx) {
+    bigint_delete(ctx.m);
+    bigint_delete(ctx.mu);
+    bigint_delete(ctx.c);
+}
+
+/* Create a reduction context for a modulus of the form 10^split - c
+* The form is used as given, without checking that c is small. Folding
+* takes more passes as c grows, so c should be well below 10^split.
+* @param split The number of low digits that folding keeps
+* @param c The offset; it may be negative, but |c| must be below 10^split / 2
+* @return A new context for m = 10^split - c, to be freed with bigint_modctx_delete
+*/
+bigint_modctx bigint_modctx_new_special(size_t split, bigint c) {
+    assert(split > 0);
+    bigint power;
+    power.is_negative = false;
+    power.size = split + 1;
+    power.digits = calloc(power.size, sizeof(int64_t));
+    power.digits[0] = 1;
+    bigint_modctx ctx;
+    ctx.m = bigint_sub(power, c);
+    bigint_normalize(&ctx.m);
+    assert(bigint_gtzero(ctx.m));
+    bigint doubled = bigint_mul_ui(c, 2);
+    doubled.is_negative = false;
+    assert(bigint_lt(doubled, power));
+    bigint_delete(doubled);
+    bigint_delete(power);
+
+    ctx.k = ctx.m.size;
+    ctx.kind = BIGINT_MODCTX_DECIMAL;
+    ctx.split = split;
+    ctx.c = bigint_copy(c);
+    bigint_normalize(&ctx.c);
+    ctx.mu = bigint_zero();
+    return ctx;
+}
+
+// Reduce a nonnegative x by folding with 10^split = c mod m
+bigint bigint_modctx_fold(bigint_modctx ctx, bigint x) {
+    bigint r = bigint_copy(x), hi, lo, tmp;
+    bool small_c = bigint_cmp_si(ctx.c, -(int64_t)1000000000) > 0 && bigint_cmp_si(ctx.c, 1000000000) < 0;
+    uint64_t c_small = small_c ? (uint64_t)(ctx.c.is_negative ? -bigint_to_int(ctx.c) : bigint_to_int(ctx.c)) : 0;
+    while (r.size > ctx.split) {
+        // hi and lo alias the digits of r
+        hi = r;
+        hi.is_negative = false;
+        hi.size = r.size - ctx.split;
+        lo = r;
+        lo.is_negative = false;
+        lo.digits += hi.size;
+        lo.size = ctx.split;
+        while (lo.size > 1 && lo.digits[0] == 0) {
+            lo.digits++;
+            lo.size--;
+        }
+        if (small_c) {
+            hi = bigint_mul_ui(hi, c_small);
+            hi.is_negative = ctx.c.is_negative;
+        } else {
+            hi = bigint_mul(hi, ctx.c);
+        }
+
+        // r = lo + hi * c, keeping the sign of the value that was folded
+        tmp = bigint_add(lo, hi);
+        if (r.is_negative) {
+            tmp.is_negative = !tmp.is_negative;
+        }
+        bigint_delete(hi);
+        bigint_delete(r);
+        r = tmp;
+        bigint_normalize(&r);
+    }
+
+    while (bigint_ltzero(r)) {
+        tmp = r;
+        r = bigint_add(r, ctx.m);
+        bigint_delete(tmp);
+    }
+    while (bigint_ge(r, ctx.m)) {
+        tmp = r;
+        r = bigint_sub(r, ctx.m);
+        bigint_delete(tmp);
+    }
+    bigint_normalize(&r);
+    return r;
+}
+
+// Barrett reduction of a nonnegative x with at most 2k digits
+bigint bigint_modctx_barrett(bigint_modctx ctx, bigint x) {
+    while (x.size > 1 && x.digits[0] == 0) {
+        x.digits++;
+        x.size--;
+    }
+    if (bigint_lt(x, ctx.m)) {
+        return bigint_copy(x);
+    }
+
+    // q1 = floor(x / 10^(k-1)), by dropping the low digits in place
+    bigint q1 = x;
+    q1.size -= ctx.k - 1;
+    bigint q2 = bigint_mul(q1, ctx.mu);
+
+    // q3 = floor(q2 / 10^(k+1))
+    bigint q3 = q2;
+    if (q3.size > ctx.k + 1) {
+        q3.size -= ctx.k + 1;
+    } else {
+        q3.size = 1;
+        q3.digits[0] = 0;
+    }
+
+    // r = x - q3 * m, which is less than 3m
+    bigint tmp1 = bigint_mul(q3, ctx.m);
+    bigint r = bigint_sub(x, tmp1);
+    bigint_delete(tmp1);
+    bigint_delete(q2);
+    while (bigint_ge(r, ctx.m)) {
+        tmp1 = r;
+        r = bigint_sub(r, ctx.m);
+        bigint_delete(tmp1);
+    }
+    return r;
+}
+
+/* Reduce a bigint by the context's modulus
+* @param ctx The reduction context
+* @param x The bigint to reduce
+* @return A new bigint with the value of x mod m, in [0, m)
+*/
+bigint bigint_modred(bigint_modctx ctx, bigint x) {
+    bool negative = x.is_negative;
+    x.is_negative = false;
+    while (x.size > 1 && x.digits[0] == 0) {
+        x.digits++;
+        x.size--;
+    }
+
+    bigint result;
+    if (ctx.kind == BIGINT_MODCTX_DECIMAL) {
+        result = bigint_modctx_fold(ctx, x);
+    } else if (x.size <= 2 * ctx.k) {
+        result = bigint_modctx_barrett(ctx, x);
+    } else {
+        // Fold in k digits at a time, keeping the running value below 10^(2k)
+        size_t first = x.size - (x.size - ctx.k) / ctx.k * ctx.k;
+        bigint chunk = x;
+        chunk.size = first;
+        result = bigint_modctx_barrett(ctx, chunk);
+
+        bigint joined;
+        joined.is_negative = false;
+        joined.digits = malloc(2 * ctx.k * sizeof(int64_t));
+        for (size_t i = first; i < x.size; i += ctx.k) {
+            joined.size = result.size + ctx.k;
+            memcpy(joined.digits, result.digits, result.size * sizeof(int64_t));
+            memcpy(joined.digits + result.size, x.digits + i, ctx.k * sizeof(int64_t));
+            bigint_delete(result);
+            result = bigint_modctx_barrett(ctx, joined);
+        }
+        bigint_delete(joined);
+    }
+
+    if (negative && !bigint_eqzero(result)) {
+        bigint tmp = result;
+        result = bigint_sub(ctx.m, result);
+        bigint_delete(tmp);
+    }
+    result.is_negative = false;
+    return result;
+}
+
+/* Multiply two bigints modulo the context's modulus
+* @param ctx The reduction context
+* @param a The first bigint
+* @param b The second bigint
+* @return A new bigint with the value of a * b mod m
+*/
+bigint bigint_modmul(bigint_modctx ctx, bigint a, bigint b) {
+    bigint product = bigint_mul(a, b);
+    bigint result = bigint_modred(ctx, product);
+    bigint_delete(product);
+    return result;
+}
+
+/* Add two bigints modulo the context's modulus
+* @param ctx The reduction context
+* @param a The first bigint
+* @param b The second bigint
+* @return A new bigint with the value of a + b mod m
+*/
+bigint bigint_modadd(bigint_modctx ctx, bigint a, bigint b) {
+    bigint sum = bigint_add(a, b);
+    if (bigint_gezero(sum) && bigint_lt(sum, ctx.m)) {
+        sum.is_negative = false;
+        return sum;
+    }
+    bigint result = bigint_modred(ctx, sum);
+    bigint_delete(sum);
+    return result;
+}
+
+/* Subtract two bigints modulo the context's modulus
+* @param ctx The reduction context
+* @param a The first bigint
+* @param b The second bigint
+* @return A new bigint with the value of a - b mod m
+*/
+bigint bigint_modsub(bigint_modctx ctx, bigint a, bigint b) {
+    bigint diff = bigint_sub(a, b);
+    if (bigint_gezero(diff) && bigint_lt(diff, ctx.m)) {
+        diff.is_negative = false;
+        return diff;
+    }
+    bigint result = bigint_modred(ctx, diff);
+    bigint_delete(diff);
+    return result;
+}
+
+/* Raise a bigint to a power modulo the context's modulus
+* @param ctx The reduction context
+* @param a The base
+* @param e The nonnegative exponent
+* @return A new bigint with the value a^e mod m, in [0, m)
+*/
+bigint bigint_modctx_pow(bigint_modctx ctx, bigint a, bigint e) {
+    // Precompute a^0 through a^9 for a window of one decimal digit
+    bigint table[10], tmp1, tmp2;
+    table[0] = bigint_modred(ctx, bigint_const_one);
+    table[1] = bigint_modred(ctx, a);
+    for (int i = 2; i < 10; i++) {
+        table[i] = bigint_modmul(ctx, table[i - 1], table[1]);
+    }
+
+    // Scan the exponent one decimal digit at a time: result = result^10 * a^digit
+    size_t start = 0;
+    while (start < e.size - 1 && e.digits[start] == 0) {
+        start++;
+    }
+    bigint result = bigint_copy(table[e.digits[start]]);
+    for (size_t i = start + 1; i < e.size; i++) {
+        tmp1 = bigint_modmul(ctx, result, result);
+        tmp2 = bigint_modmul(ctx, tmp1, tmp1);
+        bigint_delete(tmp1);
+        tmp1 = bigint_modmul(ctx, tmp2, result);
+        bigint_delete(tmp2);
+        bigint_delete(result);
+        result = bigint_modmul(ctx, tmp1, tmp1);
+        bigint_delete(tmp1);
+        if (e.digits[i] > 0) {
+            tmp1 = result;
+            result = bigint_modmul(ctx, result, table[e.digits[i]]);
+            bigint_delete(tmp1);
+        }
+    }
+
+    for (int i = 0; i < 10; i++) {
+        bigint_delete(table[i]);
+    }
+    return result;
+}
+
+bool bigint_is_odd(bigint n);
+bool bigint_is_even(bigint n);
+
+bigint bigint_fast_pow(bigint a, bigint b, bigint m) {
+    if (bigint_is_64_bit(a) && bigint_is_64_bit(b) && bigint_is_64_bit(m)) {
+        int64_t result = 1;
+        int64_t base = bigint_to_int(a);
+        int64_t exp = bigint_to_int(b);
+        int64_t mod = bigint_to_int(m);
+        base %= mod;
+        while (exp > 0) {
+            if (exp % 2 == 1) {
+                result = (result * base) % mod;
+            }
+            exp = exp >> 1;
+            base = (base * base) % mod;
+        }
+        return bigint_from_int(result);
+    }
+    
+    bigint result;
+
+    if (b.is_negative) {
+        result = bigint_zero();
+        return result;
+    }
+    if (bigint_eqzero(b)) {
+        result = bigint_copy(bigint_const_one);
+        return result;
+    }
+
+    m.is_negative = false;
+    bigint_modctx ctx = bigint_modctx_new(m);
+
+    bigint base = bigint_abs(a);
+    result = bigint_modctx_pow(ctx, base, b);
+    bigint_modctx_delete(ctx);
+
+    // Match the sign of the 64-bit path for negative bases
+    if (a.is_negative && bigint_is_odd(b) && !bigint_eqzero(result)) {
+        result.is_negative = true;
+    }
+    return result;
+}
+
+/* Fixed-base exponentiation
+* A comb table for a base g and modulus m stores g raised to every sum of
+* the powers 2^(j * columns), for j below the number of rows. An exponent of
+* up to rows * columns bits then costs columns squarings and at most
+* columns multiplications. The table is only read after it is built, so
+* one table can be shared by many threads.
+*/
+typedef struct {
+    bigint_modctx ctx;
+    bigint base;
+    // The number of rows; the table has 2^rows entries
+    size_t rows;
+    // The number of bits in each row
+    size_t columns;
+    bigint *table;
+} bigint_powtable;
+
+// The most rows a comb table may have
+#define BIGINT_POWTABLE_MAX_ROWS 16
+
+// Fill in the comb entries from the context, base and shape
+void bigint_powtable_fill(bigint_powtable *table) {
+    size_t entries = (size_t)1 << table->rows;
+    table->table = malloc(entries * sizeof(bigint));
+    table->table[0] = bigint_modred(table->ctx, bigint_const_one);
+
+    // The entry for a single row j is g^(2^(j * columns))
+    bigint power = bigint_copy(table->base), tmp;
+    for (size_t j = 0; j < table->rows; j++) {
+        if (j > 0) {
+            for (size_t k = 0; k < table->columns; k++) {
+                tmp = power;
+                power = bigint_modmul(table->ctx, power, power);
+                bigint_delete(tmp);
+            }
+        }
+        size_t row = (size_t)1 << j;
+        table->table[row] = bigint_copy(power);
+        // Every entry below row gains this row as its highest bit
+        for (size_t i = 1; i < row; i++) {
+            table->table[row + i] = bigint_modmul(table->ctx, table->table[i], power);
+        }
+    }
+    bigint_delete(power);
+}
+
+/* Build a comb table for raising a fixed base to many exponents
+* @param g The base
+* @param m The positive modulus
+* @param bits The largest exponent size in bits that uses the table
+* @param rows The number of rows, from 1 to BIGINT_POWTABLE_MAX_ROWS; the table has 2^rows entries
+* @return A new table, to be freed with bigint_powtable_delete
+*/
+bigint_powtable bigint_powtable_new(bigint g, bigint m, size_t bits, size_t rows) {
+    assert(rows >= 1 && rows <= BIGINT_POWTABLE_MAX_ROWS);
+    bigint_powtable table;
+    table.ctx = bigint_modctx_new(m);
+    table.base = bigint_modred(table.ctx, g);
+    table.rows = rows;
+    table.columns = bits == 0 ? 1 : (bits + rows - 1) / rows;
+    bigint_powtable_fill(&table);
+    return table;
+}
+
+/* Delete a comb table
+* @param table The table to delete
+*/
+void bigint_powtable_delete(bigint_powtable table) {
+    size_t entries = (size_t)1 << table.rows;
+    for (size_t i = 0; i < entries; i++) {
+        bigint_delete(table.table[i]);
+    }
+    free(table.table);
+    bigint_delete(table.base);
+    bigint_modctx_delete(table.ctx);
+}
+
+/* Raise the base of a comb table to a power
+* Exponents longer than the table was built for fall back to bigint_modctx_pow.
+* @param table The comb table
+* @param e The exponent
+* @return A new bigint with the value g^e mod m, in [0, m), or zero if e is negative
+*/
+bigint bigint_powtable_pow(bigint_powtable table, bigint e) {
+    if (e.is_negative && !bigint_eqzero(e)) {
+        return bigint_zero();
+    }
+    size_t count;
+    uint32_t *words = bigint_to_words(e, &count);
+    if (count * 32 > table.rows * table.columns) {
+        // Check the exact bit length before giving up on the table
+        size_t bits = count == 0 ? 0 : (count - 1) * 32;
+        for (uint32_t top = count == 0 ? 0 : words[count - 1]; top != 0; top >>= 1) {
+            bits++;
+        }
+        if (bits > table.rows * table.columns) {
+            free(words);
+            return bigint_modctx_pow(table.ctx, table.base, e);
+        }
+    }
+
+    // Walk the columns from the top, taking one bit from each row per step
+    bigint result = bigint_copy(table.table[0]), tmp;
+    bool started = false;
+    for (size_t k = table.columns; k-- > 0;) {
+        if (started) {
+            tmp = result;
+            result = bigint_modmul(table.ctx, result, result);
+            bigint_delete(tmp);
+        }
+        size_t index = 0;
+        for (size_t j = 0; j < table.rows; j++) {
+            size_t bit = j * table.columns + k;
+            if (bit / 32 < count && (words[bit / 32] >> (bit % 32)) & 1) {
+                index |= (size_t)1 << j;
+            }
+        }
+        if (index > 0) {
+            tmp = result;
+            result = bigint_modmul(table.ctx, result, table.table[index]);
+            bigint_delete(tmp);
+            started = true;
+        }
+    }
+    free(words);
+    return result;
+}
+
+// Write a bigint in decimal followed by a newline
+bool bigint_write_decimal(FILE *file, bigint n) {
+    return bigint_fwrite(file, n) && fputc('\n', file) != EOF;
+}
+
+// Read a nonnegative decimal bigint, skipping leading whitespace
+bool bigint_read_decimal(FILE *file, bigint *n) {
+    int c;
+    do {
+        c = fgetc(file);
+    } while (c == ' ' || c == '\n' || c == '\r' || c == '\t');
+
+    size_t size = 0, capacity = 16;
+    int64_t *digits = malloc(capacity * sizeof(int64_t));
+    while (c >= '0' && c <= '9') {
+        if (size == capacity) {
+            capacity *= 2;
+            digits = realloc(digits, capacity * sizeof(int64_t));
+        }
+        digits[size++] = c - '0';
+        c = fgetc(file);
+    }
+    if (size == 0) {
+        free(digits);
+        return false;
+    }
+    n->is_negative = false;
+    n->digits = digits;
+    n->size = size;
+    return true;
+}
+
+/* Save a comb table to a file
+* @param table The comb table
+* @param file The file to write to
+* @return Whether every write succeeded
+*/
+bool bigint_powtable_write(bigint_powtable table, FILE *file) {
+    if (fprintf(file, "bigint_powtable %zu %zu\n", table.rows, table.columns) < 0) {
+        return false;
+    }
+    bool ok = bigint_write_decimal(file, table.ctx.m) && bigint_write_decimal(file, table.base);
+    size_t entries = (size_t)1 << table.rows;
+    for (size_t i = 0; i < entries && ok; i++) {
+        ok = bigint_write_decimal(file, table.table[i]);
+    }
+    return ok;
+}
+
+/* Load a comb table saved by bigint_powtable_write
+* @param file The file to read from
+* @param table Set to a new table on success
+* @return Whether a well-formed table was read
+*/
+bool bigint_powtable_read(FILE *file, bigint_powtable *table) {
+    size_t rows, columns;
+    if (fscanf(file, "bigint_powtable %zu %zu", &rows, &columns) != 2 || rows < 1 || rows > BIGINT_POWTABLE_MAX_ROWS || columns < 1) {
+        return false;
+    }
+    bigint m, base;
+    if (!bigint_read_decimal(file, &m)) {
+        return false;
+    }
+    if (!bigint_gtzero(m) || !bigint_read_decimal(file, &base)) {
+        bigint_delete(m);
+        return false;
+    }
+    // The base and the entries are residues, in [0, m)
+    if (bigint_ltzero(base) || !bigint_lt(base, m)) {
+        bigint_delete(m);
+        bigint_delete(base);
+        return false;
+    }
+
+    size_t entries = (size_t)1 << rows;
+    bigint *entry = malloc(entries * sizeof(bigint));
+    size_t i = 0;
+    bool ok = true;
+    for (; i < entries && ok; i++) {
+        if (!bigint_read_decimal(file, &entry[i])) {
+            ok = false;
+            break;
+        }
+        ok = !bigint_ltzero(entry[i]) && bigint_lt(entry[i], m);
+    }
+    if (!ok) {
+        while (i-- > 0) {
+            bigint_delete(entry[i]);
+        }
+        free(entry);
+        bigint_delete(m);
+        bigint_delete(base);
+        return false;
+    }
+
+    table->ctx = bigint_modctx_new(m);
+    table->base = base;
+    table->rows = rows;
+    table->columns = columns;
+    table->table = entry;
+    bigint_delete(m);
+    return true;
+}
+
+/* Multi-exponentiation
+* The product of many powers shares one chain of squarings. Straus' method
+* interleaves a window table per base; for many bases, Pippenger's method
+* instead sorts the bases into buckets by their window digit.
+*/
+
+// Read width bits of a word array starting at bit, past the end reading zeros
+size_t bigint_words_window(const uint32_t *words, size_t count, size_t bit, size_t width) {
+    size_t result = 0;
+    for (size_t i = width; i-- > 0;) {
+        size_t b = bit + i;
+        result = (result << 1) | (b / 32 < count ? (words[b / 32] >> (b % 32)) & 1 : 0);
+    }
+    return result;
+}
+
+// result = result * x, or x itself while result is still the empty product
+void bigint_multi_pow_accumulate(bigint_modctx ctx, bigint *result, bool *started, bigint x) {
+    if (*started) {
+        bigint tmp = *result;
+        *result = bigint_modmul(ctx, *result, x);
+        bigint_delete(tmp);
+    } else {
+        bigint_delete(*result);
+        *result = bigint_copy(x);
+        *started = true;
+    }
+}
+
+// result = result^(2^width), skipped while result is still the empty product
+void bigint_multi_pow_square(bigint_modctx ctx, bigint *result, bool started, size_t width) {
+    for (size_t i = 0; started && i < width; i++) {
+        bigint tmp = *result;
+        *result = bigint_modmul(ctx, *result, *result);
+        bigint_delete(tmp);
+    }
+}
+
+bigint bigint_straus_pow(bigint_modctx ctx, const bigint *bases, uint32_t **words, const size_t *counts, size_t count, size_t bits) {
+    // Pick the window width that minimizes the table size plus the multiplications per base
+    size_t width = 1;
+    for (size_t w = 2; w <= 8; w++) {
+        if (((size_t)1 << w) + bits / w < ((size_t)1 << width) + bits / width) {
+            width = w;
+        }
+    }
+
+    // tables[i][d] = bases[i]^d for every window digit d
+    size_t entries = (size_t)1 << width;
+    bigint *tables = malloc(count * entries * sizeof(bigint));
+    for (size_t i = 0; i < count; i++) {
+        bigint *table = tables + i * entries;
+        table[0] = bigint_zero();
+        table[1] = bigint_modred(ctx, bases[i]);
+        for (size_t d = 2; d < entries; d++) {
+            table[d] = bigint_modmul(ctx, table[d - 1], table[1]);
+        }
+    }
+
+    bigint result = bigint_modred(ctx, bigint_const_one);
+    bool started = false;
+    for (size_t window = (bits + width - 1) / width; window-- > 0;) {
+        bigint_multi_pow_square(ctx, &result, started, width);
+        for (size_t i = 0; i < count; i++) {
+            size_t digit = bigint_words_window(words[i], counts[i], window * width, width);
+            if (digit > 0) {
+                bigint_multi_pow_accumulate(ctx, &result, &started, tables[i * entries + digit]);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count * entries; i++) {
+        bigint_delete(tables[i]);
+    }
+    free(tables);
+    return result;
+}
+
+bigint bigint_pippenger_pow(bigint_modctx ctx, const bigint *bases, uint32_t **words, const size_t *counts, size_t count, size_t bits) {
+    // Pick the window width that minimizes (bits / width) * (count + 2^(width + 1))
+    size_t width = 1;
+    for (size_t w = 2; w <= 16; w++) {
+        if ((bits + w - 1) / w * (count + ((size_t)2 << w)) < (bits + width - 1) / width * (count + ((size_t)2 << width))) {
+            width = w;
+        }
+    }
+
+    bigint *reduced = malloc(count * sizeof(bigint));
+    for (size_t i = 0; i < count; i++) {
+        reduced[i] = bigint_modred(ctx, bases[i]);
+    }
+    size_t entries = (size_t)1 << width;
+    bigint *buckets = malloc(entries * sizeof(bigint));
+    bool *filled = malloc(entries * sizeof(bool));
+
+    bigint result = bigint_modred(ctx, bigint_const_one);
+    bool started = false;
+    for (size_t window = (bits + width - 1) / width; window-- > 0;) {
+        bigint_multi_pow_square(ctx, &result, started, width);
+
+        // Bucket d holds the product of the bases whose window digit is d
+        memset(filled, 0, entries * sizeof(bool));
+        for (size_t i = 0; i < count; i++) {
+            size_t digit = bigint_words_window(words[i], counts[i], window * width, width);
+            if (digit > 0) {
+                if (!filled[digit]) {
+                    buckets[digit] = bigint_zero();
+                }
+                bigint_multi_pow_accumulate(ctx, &buckets[digit], &filled[digit], reduced[i]);
+            }
+        }
+
+        // The product of bucket[d]^d, as a product of running products from the top bucket down
+        bigint running = bigint_zero(), sum = bigint_zero();
+        bool running_started = false, sum_started = false;
+        for (size_t d = entries; d-- > 1;) {
+            if (filled[d]) {
+                bigint_multi_pow_accumulate(ctx, &running, &running_started, buckets[d]);
+                bigint_delete(buckets[d]);
+            }
+            if (running_started) {
+                bigint_multi_pow_accumulate(ctx, &sum, &sum_started, running);
+            }
+        }
+        if (sum_started) {
+            bigint_multi_pow_accumulate(ctx, &result, &started, sum);
+        }
+        bigint_delete(running);
+        bigint_delete(sum);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        bigint_delete(reduced[i]);
+    }
+    free(reduced);
+    free(buckets);
+    free(filled);
+    return result;
+}
+
+/* Find the product of many powers modulo the context's modulus
+* All exponents share one chain of squarings. Fewer than
+* bigint_thresholds.pippenger bases use Straus' interleaved windows, and
+* more use Pippenger's bucket method.
+* @param ctx The reduction context
+* @param bases The bases
+* @param exponents The nonnegative exponents, one for each base
+* @param count The number of bases
+* @return A new bigint with the value of the product of bases[i]^exponents[i] mod m, in [0, m)
+*/
+bigint bigint_multi_pow(bigint_modctx ctx, const bigint *bases, const bigint *exponents, size_t count) {
+    uint32_t **words = malloc((count + 1) * sizeof(uint32_t *));
+    size_t *counts = malloc((count + 1) * sizeof(size_t));
+    size_t bits = 0;
+    for (size_t i = 0; i < count; i++) {
+        assert(!exponents[i].is_negative || bigint_eqzero(exponents[i]));
+        words[i] = bigint_to_words(exponents[i], &counts[i]);
+        if (counts[i] * 32 > bits) {
+            bits = counts[i] * 32;
+        }
+    }
+
+    bigint result;
+    if (count >= bigint_thresholds.pippenger) {
+        result = bigint_pippenger_pow(ctx, bases, words, counts, count, bits);
+    } else {
+        result = bigint_straus_pow(ctx, bases, words, counts, count, bits);
+    }
+    for (size_t i = 0; i < count; i++) {
+        free(words[i]);
+    }
+    free(words);
+    free(counts);
+
+    return result;
+}
+
+bigint bigint_modinv(bigint a, bigint m) {
+    bigint m0 = bigint_copy(m);
+    bigint y = bigint_zero();
+    bigint x = bigint_copy(bigint_const_one);
+    bigint q = bigint_zero();
+    bigint t = bigint_zero();
+    a = bigint_copy(a);
+    m = bigint_copy(m);
+
+    bigint tmp1, tmp2;
+    while (!bigint_eqzero(a)) {
+        tmp1 = q;
+        q = bigint_div(m, a);
+        bigint_delete(tmp1);
+
+        tmp1 = t;
+        tmp2 = bigint_mul(q, a);
+        t = bigint_sub(m, tmp2);
+        bigint_delete(tmp1);
+        bigint_delete(tmp2);
+
+        // (m, a) = (a, t), leaving the old m in t to be freed
+        bigint_swap(&m, &a);
+        bigint_swap(&a, &t);
+
+        tmp1 = t;
+        tmp2 = bigint_mul(q, x);
+        t = bigint_sub(y, tmp2);
+        bigint_delete(tmp1);
+        bigint_delete(tmp2);
+
+        // (y, x) = (x, t), leaving the old y in t to be freed
+        bigint_swap(&y, &x);
+        bigint_swap(&x, &t);
+    }
+    if (bigint_ltzero(m)) {
+        tmp1 = m;
+        m = bigint_add(m, m0);
+        bigint_delete(tmp1);
+    }
+
+    if (bigint_cmp_si(m, 1) == 0) {
+        bigint result = bigint_mod(y, m0);
+        if (bigint_ltzero(result)) {
+            tmp1 = result;
+            result = bigint_add(result, m0);
+            bigint_delete(tmp1);
+        }
+        bigint_delete(a);
+        bigint_delete(m);
+        bigint_delete(m0);
+        bigint_delete(y);
+        bigint_delete(x);
+        bigint_delete(q);
+        bigint_delete(t);
+        return result;
+    }
+    bigint_delete(a);
+    bigint_delete(m);
+    bigint_delete(m0);
+    bigint_delete(y);
+    bigint_delete(x);
+    bigint_delete(q);
+    bigint_delete(t);
+    return bigint_from_int(0);
+}
+
+/* Find the greatest common divisor of two bigints
+* @param a The first bigint
+* @param b The second bigint
+* @return A new, nonnegative bigint with the value gcd(a, b)
+*/
+bigint bigint_gcd(bigint a, bigint b) {
+    a = bigint_copy(a);
+    b = bigint_copy(b);
+    a.is_negative = false;
+    b.is_negative = false;
+    while (!bigint_eqzero(b)) {
+        bigint tmp = bigint_mod(a, b);
+        bigint_delete(a);
+        a = b;
+        b = tmp;
+    }
+    bigint_delete(b);
+    bigint_normalize(&a);
+    return a;
+}
+
+// One pass of Montgomery's trick over the residues selected by index; fails if their product is not invertible
+bool bigint_modinv_batch_pass(bigint_modctx ctx, const bigint *residues, const size_t *index, size_t count, bigint *inverses) {
+    // prefix[k] = residues[index[0]] * ... * residues[index[k]]
+    bigint *prefix = malloc(count * sizeof(bigint));
+    prefix[0] = bigint_copy(residues[index[0]]);
+    for (size_t k = 1; k < count; k++) {
+        prefix[k] = bigint_modmul(ctx, prefix[k - 1], residues[index[k]]);
+    }
+
+    bigint inverse = bigint_modinv(prefix[count - 1], ctx.m);
+    bool invertible = !bigint_eqzero(inverse);
+    if (invertible) {
+        // Peel one residue off the inverted product at a time
+        for (size_t k = count - 1; k > 0; k--) {
+            inverses[index[k]] = bigint_modmul(ctx, inverse, prefix[k - 1]);
+            bigint tmp = inverse;
+            inverse = bigint_modmul(ctx, inverse, residues[index[k]]);
+            bigint_delete(tmp);
+        }
+        inverses[index[0]] = inverse;
+    } else {
+        bigint_delete(inverse);
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        bigint_delete(prefix[k]);
+    }
+    free(prefix);
+    return invertible;
+}
+
+/* Invert many bigints modulo the same modulus with Montgomery's trick
+* This takes one modular inversion and about 3n modular multiplications.
+* @param ctx The reduction context of the modulus
+* @param values The bigints to invert
+* @param count The number of values
+* @param inverses An array of count entries that receives a new bigint for each value:
+*                 its inverse in [1, m), or zero if it is not invertible
+* @return The number of values that were not invertible
+*/
+size_t bigint_modinv_batch(bigint_modctx ctx, const bigint *values, size_t count, bigint *inverses) {
+    bigint *residues = malloc(count * sizeof(bigint));
+    size_t *index = malloc(count * sizeof(size_t));
+    size_t selected = 0;
+    for (size_t i = 0; i < count; i++) {
+        residues[i] = bigint_modred(ctx, values[i]);
+        if (bigint_eqzero(residues[i])) {
+            inverses[i] = bigint_zero();
+        } else {
+            index[selected++] = i;
+        }
+    }
+
+    if (selected > 0 && !bigint_modinv_batch_pass(ctx, residues, index, selected, inverses)) {
+        // Some value shares a factor with the modulus: find them by gcd and retry without them
+        size_t kept = 0;
+        for (size_t k = 0; k < selected; k++) {
+            bigint g = bigint_gcd(residues[index[k]], ctx.m);
+            if (bigint_cmp_si(g, 1) == 0) {
+                index[kept++] = index[k];
+            } else {
+                inverses[index[k]] = bigint_zero();
+            }
+            bigint_delete(g);
+        }
+        selected = kept;
+        if (selected > 0) {
+            bool invertible = bigint_modinv_batch_pass(ctx, residues, index, selected, inverses);
+            assert(invertible);
+            (void)invertible;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        bigint_delete(residues[i]);
+    }
+    free(residues);
+    free(index);
+    return count - selected;
+}
+
+// floor(sqrt(n)) for a nonnegative n
+bigint bigint_isqrt(bigint n) {
+    if (n.size <= 18) {
+        uint64_t value = (uint64_t)bigint_to_int(n);
+        uint64_t x = value, y = (x + 1) / 2;
+        while (y < x) {
+            x = y;
+            y = (x + value / x) / 2;
+        }
+        return bigint_from_int((int64_t)x);
+    }
+
+    // The root of the top half of the digits, rounded up, overestimates the
+    // root of n to about a quarter of its digits, and Newton's iteration
+    // from above doubles that each step until it stops decreasing.
+    size_t j = n.size / 4;
+    bigint top = bigint_from_view(bigint_view_slice(bigint_view_of(n), 2 * j, n.size));
+    bigint s = bigint_isqrt(top);
+    bigint_add_ui_inplace(&s, 1);
+    bigint x = bigint_digits_scale(s, j);
+    bigint_delete(s);
+    while (true) {
+        bigint remainder;
+        bigint quotient = bigint_divmod(n, x, &remainder);
+        bigint sum = bigint_add(x, quotient);
+        uint64_t odd;
+        bigint y = bigint_divmod_ui(sum, 2, &odd);
+        bigint_delete(remainder);
+        bigint_delete(quotient);
+        bigint_delete(sum);
+        if (!bigint_lt(y, x)) {
+            bigint_delete(y);
+            return x;
+        }
+        bigint_delete(x);
+        x = y;
+    }
+}
+
+/* Integer square root, rounded up
+* Uses Newton's iteration seeded from the root of the leading digits, so the
+* cost is a few divisions at full size.
+* @param n The radicand
+* @return The smallest x with x * x >= n, or 0 when n is not positive
+*/
+bigint bigint_sqrt(bigint n) {
+    if (n.is_negative || (n.size == 1 && n.digits[0] == 0)) {
+        return bigint_zero();
+    }
+    bigint root = bigint_isqrt(n);
+    bigint square = bigint_mul(root, root);
+    if (bigint_lt(square, n)) {
+        bigint_add_ui_inplace(&root, 1);
+    }
+    bigint_delete(square);
+    return root;
+}
+
+bool bigint_is_even(bigint n) {
+    return n.digits[n.size - 1] % 2 == 0;
+}
+
+bool bigint_is_odd(bigint n) {
+    return n.digits[n.size - 1] % 2 == 1;
+}
+
+bool bigint_is_prime(bigint n) {
+    // Check if the number is even
+    if (bigint_is_even(n)) {
+        return false;
+    }
+
+    // If the last digit is a 5 or 0, the number is divisible by 5
+    if (n.size > 1 && (n.digits[n.size - 1] == 5 || n.digits[n.size - 1] == 0)) {
+        return false;
+    }
+    // Check if the number is divisible by 3
+    if (bigint_divisible_ui_p(n, 3)) {
+        return false;
+    }
+
+    bigint sqrt_n = bigint_sqrt(n);
+    
+    for (uint64_t d = 2; bigint_cmp_si(sqrt_n, (int64_t)d) >= 0; d++) {
+        if (bigint_divisible_ui_p(n, d)) {
+            bigint_delete(sqrt_n);
+            return false;
+        }
+    }
+    bigint_delete(sqrt_n);
+    return true;
+}
+
+/* Find all primes up to a limit with the sieve of Eratosthenes
+* @param n The (inclusive) upper limit
+* @param count Set to the number of primes found
+* @return A new array of the primes in increasing order, to be freed by the caller
+*/
+uint64_t *bigint_primes_up_to(uint64_t n, size_t *count) {
+    *count = 0;
+    if (n < 2) {
+        return malloc(sizeof(uint64_t));
+    }
+    char *composite = calloc(n + 1, 1);
+    for (uint64_t i = 2; i * i <= n; i++) {
+        if (!composite[i]) {
+            for (uint64_t j = i * i; j <= n; j += i) {
+                composite[j] = 1;
+            }
+        }
+    }
+    size_t found = 0;
+    for (uint64_t i = 2; i <= n; i++) {
+        found += !composite[i];
+    }
+    uint64_t *primes = malloc(found * sizeof(uint64_t));
+    for (uint64_t i = 2; i <= n; i++) {
+        if (!composite[i]) {
+            primes[(*count)++] = i;
+        }
+    }
+    free(composite);
+    return primes;
+}
+
+// Below this many factors, a product tree multiplies its leaves in sequence
+#define BIGINT_PRODUCT_TREE_LEAF 16
+
+// How many levels of a product tree are split across threads
+#ifndef BIGINT_THREAD_DEPTH
+#define BIGINT_THREAD_DEPTH 2
+#endif
+
+// The number of threads used by flat parallel loops
+#ifndef BIGINT_THREAD_COUNT
+#define BIGINT_THREAD_COUNT 4
+#endif
+
+#ifdef BIGINT_THREADS
+// The number of threads in the worker pool, counting the caller; 0 uses one per core
+#ifndef BIGINT_POOL_THREADS
+#define BIGINT_POOL_THREADS 0
+#endif
+
+// Run part number part of parts of a job
+typedef void (*bigint_pool_fn)(void *arg, size_t part, size_t parts);
+
+/* A persistent pool of worker threads
+* Workers start on first use and then wait for jobs, so a job costs a
+* wakeup rather than a thread creation. One job runs at a time; callers
+* that find the pool busy, including jobs that start jobs, run inline.
+*/
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t start, done;
+    pthread_mutex_t busy;
+    size_t threads;
+    uint64_t generation;
+    bigint_pool_fn fn;
+    void *arg;
+    size_t parts, next, remaining;
+} bigint_pool_state;
+
+bigint_pool_state bigint_pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                                 PTHREAD_MUTEX_INITIALIZER, 1, 0, NULL, NULL, 0, 0, 0};
+pthread_once_t bigint_pool_once = PTHREAD_ONCE_INIT;
+
+// Claim and run parts of the current job; called and returns with the lock held
+void bigint_pool_drain(void) {
+    while (bigint_pool.next < bigint_pool.parts) {
+        size_t part = bigint_pool.next++;
+        bigint_pool_fn fn = bigint_pool.fn;
+        void *arg = bigint_pool.arg;
+        size_t parts = bigint_pool.parts;
+        pthread_mutex_unlock(&bigint_pool.lock);
+        fn(arg, part, parts);
+        pthread_mutex_lock(&bigint_pool.lock);
+        if (--bigint_pool.remaining == 0) {
+            pthread_cond_signal(&bigint_pool.done);
+        }
+    }
+}
+
+void *bigint_pool_worker(void *unused) {
+    (void)unused;
+    uint64_t seen = 0;
+    pthread_mutex_lock(&bigint_pool.lock);
+    for (;;) {
+        while (bigint_pool.generation == seen) {
+            pthread_cond_wait(&bigint_pool.start, &bigint_pool.lock);
+        }
+        seen = bigint_pool.generation;
+        bigint_pool_drain();
+    }
+    return NULL;
+}
+
+void bigint_pool_start(void) {
+    size_t threads = BIGINT_POOL_THREADS;
+#ifdef BIGINT_POSIX
+    if (threads == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cores > 0 ? (size_t)cores : 1;
+    }
+#endif
+    if (threads == 0) {
+        threads = BIGINT_THREAD_COUNT;
+    }
+    bigint_pool.threads = 1;
+    for (size_t t = 1; t < threads; t++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, bigint_pool_worker, NULL) != 0) {
+            break;
+        }
+        pthread_detach(thread);
+        bigint_pool.threads++;
+    }
+}
+
+/* The number of threads a job can run on
+* @return The pool size, counting the calling thread
+*/
+size_t bigint_pool_size(void) {
+    pthread_once(&bigint_pool_once, bigint_pool_start);
+    return bigint_pool.threads;
+}
+
+/* Run the parts of a job on the pool, including the calling thread
+* @param fn The function that runs one part
+* @param arg The argument passed to every part
+* @param parts The number of parts
+*/
+void bigint_pool_run(bigint_pool_fn fn, void *arg, size_t parts) {
+    if (parts <= 1 || bigint_pool_size() <= 1 || pthread_mutex_trylock(&bigint_pool.busy) != 0) {
+        for (size_t part = 0; part < parts; part++) {
+            fn(arg, part, parts);
+        }
+        return;
+    }
+    pthread_mutex_lock(&bigint_pool.lock);
+    bigint_pool.fn = fn;
+    bigint_pool.arg = arg;
+    bigint_pool.parts = parts;
+    bigint_pool.next = 0;
+    bigint_pool.remaining = parts;
+    bigint_pool.generation++;
+    pthread_cond_broadcast(&bigint_pool.start);
+    bigint_pool_drain();
+    while (bigint_pool.remaining > 0) {
+        pthread_cond_wait(&bigint_pool.done, &bigint_pool.lock);
+    }
+    pthread_mutex_unlock(&bigint_pool.lock);
+    pthread_mutex_unlock(&bigint_pool.busy);
+}
+#endif
+
+bigint bigint_product_tree(const uint64_t *factors, size_t count, int depth);
+
+#ifdef BIGINT_THREADS
+// The subtrees BIGINT_THREAD_DEPTH levels down, one per part, computed on the pool
+typedef struct {
+    const uint64_t *factors;
+    size_t count;
+    bigint *results;
+} bigint_product_job;
+
+void bigint_product_part(void *arg, size_t part, size_t parts) {
+    bigint_product_job *job = arg;
+    size_t low = job->count * part / parts, high = job->count * (part + 1) / parts;
+    job->results[part] = bigint_product_tree(job->factors + low, high - low, BIGINT_THREAD_DEPTH);
+}
+#endif
+
+/* Multiply word-sized factors with a balanced product tree
+* With BIGINT_THREADS defined, the 2^BIGINT_THREAD_DEPTH subtrees below the
+* top levels are computed as one job on the worker pool.
+* @param factors The word-sized factors
+* @param count The number of factors
+* @param depth The depth of this subtree in the whole tree
+* @return The product of the factors
+*/
+bigint bigint_product_tree(const uint64_t *factors, size_t count, int depth) {
+    bigint result;
+    if (count <= BIGINT_PRODUCT_TREE_LEAF) {
+        result = bigint_from_int(1);
+        for (size_t i = 0; i < count; i++) {
+            bigint_mul_ui_inplace(&result, factors[i]);
+        }
+        return result;
+    }
+
+#ifdef BIGINT_THREADS
+    size_t parts = (size_t)1 << BIGINT_THREAD_DEPTH;
+    if (depth == 0 && parts > 1 && count > parts * BIGINT_PRODUCT_TREE_LEAF) {
+        bigint *results = malloc(parts * sizeof(bigint));
+        bigint_product_job job = {factors, count, results};
+        bigint_pool_run(bigint_product_part, &job, parts);
+        // Multiply the subtrees back up in pairs
+        for (size_t width = 1; width < parts; width *= 2) {
+            for (size_t i = 0; i + width < parts; i += 2 * width) {
+                bigint product = bigint_mul(results[i], results[i + width]);
+                bigint_delete(results[i]);
+                bigint_delete(results[i + width]);
+                results[i] = product;
+            }
+        }
+        result = results[0];
+        free(results);
+        return result;
+    }
+#endif
+
+    size_t half = count / 2;
+    bigint left = bigint_product_tree(factors, half, depth + 1);
+    bigint right = bigint_product_tree(factors + half, count - half, depth + 1);
+    result = bigint_mul(left, right);
+    bigint_delete(left);
+    bigint_delete(right);
+    return result;
+}
+
+/* Returns the coefficient of term n of a hypergeometric series
+* @param n The term index
+* @param data The series' user data
+* @return A new bigint
+*/
+typedef bigint (*bigint_series_fn)(uint64_t n, void *data);
+
+/* A series sum over n of a(n) * p(0) * ... * p(n) / (q(0) * ... * q(n))
+* A NULL a stands for a(n) = 1.
+*/
+typedef struct {
+    bigint_series_fn p;
+    bigint_series_fn q;
+    bigint_series_fn a;
+    void *data;
+} bigint_series;
+
+/* The partial products of a range of series terms
+* For terms [start, end), p and q are the products of p(n) and q(n), and
+* t / q is the sum of the terms relative to the product of p and q before start.
+*/
+typedef struct {
+    bigint p;
+    bigint q;
+    bigint t;
+} bigint_bsplit;
+
+bigint_bsplit bigint_series_bsplit_range(bigint_series series, uint64_t start, uint64_t end, int depth);
+
+// Merge the partial products of two adjacent ranges, freeing them
+bigint_bsplit bigint_bsplit_merge(bigint_bsplit left, bigint_bsplit right) {
+    // T = T1 * Q2 + P1 * T2
+    bigint_bsplit result;
+    bigint tq = bigint_mul(left.t, right.q);
+    bigint pt = bigint_mul(left.p, right.t);
+    result.t = bigint_add(tq, pt);
+    result.p = bigint_mul(left.p, right.p);
+    result.q = bigint_mul(left.q, right.q);
+    bigint_delete(tq);
+    bigint_delete(pt);
+    bigint_delete(left.p);
+    bigint_delete(left.q);
+    bigint_delete(left.t);
+    bigint_delete(right.p);
+    bigint_delete(right.q);
+    bigint_delete(right.t);
+    return result;
+}
+
+#ifdef BIGINT_THREADS
+// The ranges BIGINT_THREAD_DEPTH levels down, one per part, computed on the pool
+typedef struct {
+    bigint_series series;
+    uint64_t start;
+    uint64_t end;
+    bigint_bsplit *results;
+} bigint_bsplit_job;
+
+void bigint_bsplit_part(void *arg, size_t part, size_t parts) {
+    bigint_bsplit_job *job = arg;
+    uint64_t length = job->end - job->start;
+    uint64_t low = job->start + length * part / parts, high = job->start + length * (part + 1) / parts;
+    job->results[part] = bigint_series_bsplit_range(job->series, low, high, BIGINT_THREAD_DEPTH);
+}
+#endif
+
+// Binary splitting over [start, end) at the given depth of the tree
+bigint_bsplit bigint_series_bsplit_range(bigint_series series, uint64_t start, uint64_t end, int depth) {
+    bigint_bsplit result;
+    if (end - start == 1) {
+        result.p = series.p(start, series.data);
+        result.q = series.q(start, series.data);
+        if (series.a) {
+            bigint a = series.a(start, series.data);
+            result.t = bigint_mul(a, result.p);
+            bigint_delete(a);
+        } else {
+            result.t = bigint_copy(result.p);
+        }
+        return result;
+    }
+
+#ifdef BIGINT_THREADS
+    size_t parts = (size_t)1 << BIGINT_THREAD_DEPTH;
+    if (depth == 0 && parts > 1 && end - start >= parts) {
+        bigint_bsplit *results = malloc(parts * sizeof(bigint_bsplit));
+        bigint_bsplit_job job = {series, start, end, results};
+        bigint_pool_run(bigint_bsplit_part, &job, parts);
+        // Merge adjacent ranges back up in pairs, keeping their order
+        for (size_t width = 1; width < parts; width *= 2) {
+            for (size_t i = 0; i + width < parts; i += 2 * width) {
+                results[i] = bigint_bsplit_merge(results[i], results[i + width]);
+            }
+        }
+        result = results[0];
+        free(results);
+        return result;
+    }
+#endif
+
+    uint64_t middle = start + (end - start) / 2;
+    bigint_bsplit left = bigint_series_bsplit_range(series, start, middle, depth + 1);
+    bigint_bsplit right = bigint_series_bsplit_range(series, middle, end, depth + 1);
+    return bigint_bsplit_merge(left, right);
+}
+
+/* Sum a range of hypergeometric series terms by binary splitting
+* The range is halved recursively and the halves merged with
+* P = P1 P2, Q = Q1 Q2 and T = T1 Q2 + P1 T2, so the big products are balanced
+* and land in the fast multiplication tiers. With BIGINT_THREADS defined, the
+* 2^BIGINT_THREAD_DEPTH ranges below the top levels are computed as one job on
+* the worker pool.
+* @param series The series
+* @param start The first term
+* @param end One past the last term, greater than start
+* @return The partial products, to be freed with bigint_bsplit_delete
+*/
+bigint_bsplit bigint_series_bsplit(bigint_series series, uint64_t start, uint64_t end) {
+    assert(start < end);
+    return bigint_series_bsplit_range(series, start, end, 0);
+}
+
+/* Free the partial products of a binary splitting
+* @param split The partial products
+*/
+void bigint_bsplit_delete(bigint_bsplit split) {
+    bigint_delete(split.p);
+    bigint_delete(split.q);
+    bigint_delete(split.t);
+}
+
+/* Evaluate a series as a fixed-point decimal
+* @param series The series
+* @param terms The number of terms to sum, starting at term 0
+* @param digits The number of decimal digits after the point
+* @return 10^digits * sum truncated toward zero, as a new bigint
+*/
+bigint bigint_series_fixed(bigint_series series, uint64_t terms, size_t digits) {
+    bigint_bsplit split = bigint_series_bsplit(series, 0, terms);
+    bigint scaled = bigint_digits_scale(split.t, digits);
+    bigint remainder;
+    bigint result = bigint_divmod(scaled, split.q, &remainder);
+    bigint_delete(remainder);
+    bigint_delete(scaled);
+    bigint_bsplit_delete(split);
+    return result;
+}
+
+/* Packs small factors into words so that product tree leaves stay
+* in the 64-bit multiplication path
+*/
+typedef struct {
+    uint64_t *words;
+    size_t count;
+    size_t capacity;
+    uint64_t current;
+} bigint_factor_list;
+
+void bigint_factor_list_push(bigint_factor_list *list, uint64_t factor) {
+    if (factor <= 999999999 / list->current) {
+        list->current *= factor;
+        return;
+    }
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->words = realloc(list->words, list->capacity * sizeof(uint64_t));
+    }
+    list->words[list->count++] = list->current;
+    list->current = factor;
+}
+
+bigint bigint_factor_list_product(bigint_factor_list *list) {
+    bigint_factor_list_push(list, 1000000000);
+    bigint result = bigint_product_tree(list->words, list->count, 0);
+    free(list->words);
+    return result;
+}
+
+// The exponent of the prime p in n!, by Legendre's formula
+uint64_t bigint_legendre_ui(uint64_t n, uint64_t p) {
+    uint64_t e = 0;
+    while (n > 0) {
+        n /= p;
+        e += n;
+    }
+    return e;
+}
+
+/* Compute a factorial
+* The prime factorization of n! is found with Legendre's formula and
+* multiplied out with a balanced product tree.
+* @param n The integer to compute the factorial of
+* @return A new bigint with the value of n!
+*/
+bigint bigint_fac_ui(uint64_t n) {
+    size_t count;
+    uint64_t *primes = bigint_primes_up_to(n, &count);
+    bigint_factor_list list = {NULL, 0, 0, 1};
+    for (size_t i = 0; i < count; i++) {
+        uint64_t e = bigint_legendre_ui(n, primes[i]);
+        for (uint64_t j = 0; j < e; j++) {
+            bigint_factor_list_push(&list, primes[i]);
+        }
+    }
+    free(primes);
+    return bigint_factor_list_product(&list);
+}
+
+/* Compute a binomial coefficient
+* @param n The size of the set
+* @param k The size of the subsets
+* @return A new bigint with the value of n choose k
+*/
+bigint bigint_bin_ui(uint64_t n, uint64_t k) {
+    if (k > n) {
+        return bigint_zero();
+    }
+    size_t count;
+    uint64_t *primes = bigint_primes_up_to(n, &count);
+    bigint_factor_list list = {NULL, 0, 0, 1};
+    for (size_t i = 0; i < count; i++) {
+        uint64_t p = primes[i];
+        uint64_t e = bigint_legendre_ui(n, p) - bigint_legendre_ui(k, p) - bigint_legendre_ui(n - k, p);
+        for (uint64_t j = 0; j < e; j++) {
+            bigint_factor_list_push(&list, p);
+        }
+    }
+    free(primes);
+    return bigint_factor_list_product(&list);
+}
+
+/* Compute a primorial
+* @param n The (inclusive) upper limit
+* @return A new bigint with the product of all primes up to n
+*/
+bigint bigint_primorial_ui(uint64_t n) {
+    size_t count;
+    uint64_t *primes = bigint_primes_up_to(n, &count);
+    bigint_factor_list list = {NULL, 0, 0, 1};
+    for (size_t i = 0; i < count; i++) {
+        bigint_factor_list_push(&list, primes[i]);
+    }
+    free(primes);
+    return bigint_factor_list_product(&list);
+}
+
+/* A residue number system base: a set of word-sized primes
+* A bigint x with |x| < modulus / 2 is represented by its residues mod each prime.
+*/
+typedef struct {
+    // The channel moduli, each below 2^31 so that products fit in 64 bits
+    uint64_t *primes;
+    size_t count;
+    // inverses[i * count + j] = primes[i]^-1 mod primes[j], for i < j
+    uint64_t *inverses;
+    // The product of the primes
+    bigint modulus;
+    // floor(modulus / 2), the largest representable magnitude
+    bigint half;
+} bigint_rns_base;
+
+/* A bigint in residue number system form
+* Addition, subtraction and multiplication work on each channel
+* independently, with no carries between channels.
+*/
+typedef struct {
+    uint64_t *residues;
+    size_t count;
+} bigint_rns;
+
+// Above this many channel operations, RNS work is split across the thread pool
+#ifndef BIGINT_RNS_THREAD_WORK
+#define BIGINT_RNS_THREAD_WORK 65536
+#endif
+
+/* Create a residue number system base
+* @param digits The number of decimal digits the base must represent
+* @return A new base, to be freed with bigint_rns_base_delete
+*/
+bigint_rns_base bigint_rns_base_new(size_t digits) {
+    bigint_rns_base base;
+    base.count = 0;
+    base.primes = NULL;
+    base.modulus = bigint_from_int(1);
+
+    // The modulus must exceed 2 * 10^digits to hold signed values
+    bigint limit;
+    limit.is_negative = false;
+    limit.size = digits + 1;
+    limit.digits = calloc(limit.size, sizeof(int64_t));
+    limit.digits[0] = 2;
+
+    for (uint64_t p = 2147483647; bigint_le(base.modulus, limit); p -= 2) {
+        bool prime = true;
+        for (uint64_t d = 3; d * d <= p; d += 2) {
+            if (p % d == 0) {
+                prime = false;
+                break;
+            }
+        }
+        if (!prime) {
+            continue;
+        }
+        base.primes = realloc(base.primes, (base.count + 1) * sizeof(uint64_t));
+        base.primes[base.count++] = p;
+        bigint_mul_ui_inplace(&base.modulus, p);
+    }
+    bigint_delete(limit);
+
+    base.half = bigint_shr(base.modulus, 1);
+
+    // Precompute the inverses for mixed-radix conversion
+    base.inverses = malloc(base.count * base.count * sizeof(uint64_t));
+    for (size_t i = 0; i < base.count; i++) {
+        for (size_t j = i + 1; j < base.count; j++) {
+            uint64_t pj = base.primes[j];
+            base.inverses[i * base.count + j] = bigint_powmod_ui(base.primes[i], pj - 2, pj);
+        }
+    }
+    return base;
+}
+
+/* Delete a residue number system base
+* @param base The base to delete
+*/
+void bigint_rns_base_delete(bigint_rns_base base) {
+    free(base.primes);
+    free(base.inverses);
+    bigint_delete(base.modulus);
+    bigint_delete(base.half);
+}
+
+/* Delete a bigint in residue number system form
+* @param x The value to delete
+*/
+void bigint_rns_delete(bigint_rns x) {
+    free(x.residues);
+}
+
+/* Create a bigint in residue number system form with the value zero
+* @param base The residue number system base
+* @return A new value, for example to hold the results of bigint_rns_run
+*/
+bigint_rns bigint_rns_new(bigint_rns_base base) {
+    bigint_rns result = {calloc(base.count, sizeof(uint64_t)), base.count};
+    return result;
+}
+
+typedef enum {
+    BIGINT_RNS_ADD,
+    BIGINT_RNS_SUB,
+    BIGINT_RNS_MUL,
+} bigint_rns_op;
+
+// Apply an operation to channels [begin, end)
+void bigint_rns_kernel(bigint_rns_op op, const uint64_t *primes, const uint64_t *a, const uint64_t *b, uint64_t *r, size_t begin, size_t end) {
+    switch (op) {
+    case BIGINT_RNS_ADD:
+        for (size_t i = begin; i < end; i++) {
+            uint64_t sum = a[i] + b[i];
+            r[i] = sum >= primes[i] ? sum - primes[i] : sum;
+        }
+        break;
+    case BIGINT_RNS_SUB:
+        for (size_t i = begin; i < end; i++) {
+            uint64_t diff = a[i] + primes[i] - b[i];
+            r[i] = diff >= primes[i] ? diff - primes[i] : diff;
+        }
+        break;
+    case BIGINT_RNS_MUL:
+        for (size_t i = begin; i < end; i++) {
+            r[i] = a[i] * b[i] % primes[i];
+        }
+        break;
+    }
+}
+
+/* One step of a chain of RNS operations
+* Sets values[r] to values[a] op values[b]. The destination may be one of
+* the operands, since each channel only reads its own residues.
+*/
+typedef struct {
+    bigint_rns_op op;
+    size_t r, a, b;
+} bigint_rns_step;
+
+typedef struct {
+    const uint64_t *primes;
+    bigint_rns *values;
+    const bigint_rns_step *steps;
+    size_t count, channels;
+} bigint_rns_job;
+
+// Run every step of a chain on one range of channels
+void bigint_rns_job_part(void *arg, size_t part, size_t parts) {
+    bigint_rns_job *job = arg;
+    size_t begin = job->channels * part / parts, end = job->channels * (part + 1) / parts;
+    for (size_t s = 0; s < job->count; s++) {
+        const bigint_rns_step *step = &job->steps[s];
+        bigint_rns_kernel(step->op, job->primes, job->values[step->a].residues, job->values[step->b].residues,
+                          job->values[step->r].residues, begin, end);
+    }
+}
+
+/* Run a chain of RNS operations
+* Each thread runs the whole chain on its own range of channels, so a
+* long chain costs one dispatch. With BIGINT_THREADS defined, chains of
+* at least BIGINT_RNS_THREAD_WORK channel operations use the thread pool.
+* @param base The residue number system base
+* @param values The values the steps read and write, all in this base
+* @param steps The steps, run in order on each channel
+* @param count The number of steps
+*/
+void bigint_rns_run(bigint_rns_base base, bigint_rns *values, const bigint_rns_step *steps, size_t count) {
+    bigint_rns_job job = {base.primes, values, steps, count, base.count};
+#ifdef BIGINT_THREADS
+    if (count * base.count >= BIGINT_RNS_THREAD_WORK) {
+        size_t parts = bigint_pool_size();
+        if (parts > base.count) {
+            parts = base.count;
+        }
+        bigint_pool_run(bigint_rns_job_part, &job, parts);
+        return;
+    }
+#endif
+    bigint_rns_job_part(&job, 0, 1);
+}
+
+bigint_rns bigint_rns_apply(bigint_rns_op op, bigint_rns_base base, bigint_rns a, bigint_rns b) {
+    assert(a.count == base.count && b.count == base.count);
+    bigint_rns values[3] = {a, b, {malloc(base.count * sizeof(uint64_t)), base.count}};
+    bigint_rns_step step = {op, 2, 0, 1};
+    bigint_rns_run(base, values, &step, 1);
+    return values[2];
+}
+
+/* Add two bigints in residue number system form
+* @param base The residue number system base
+* @param a The first value
+* @param b The second value
+* @return A new value with the sum of a and b
+*/
+bigint_rns bigint_rns_add(bigint_rns_base base, bigint_rns a, bigint_rns b) {
+    return bigint_rns_apply(BIGINT_RNS_ADD, base, a, b);
+}
+
+/* Subtract two bigints in residue number system form
+* @param base The residue number system base
+* @param a The first value
+* @param b The second value
+* @return A new value with the difference of a and b
+*/
+bigint_rns bigint_rns_sub(bigint_rns_base base, bigint_rns a, bigint_rns b) {
+    return bigint_rns_apply(BIGINT_RNS_SUB, base, a, b);
+}
+
+/* Multiply two bigints in residue number system form
+* @param base The residue number system base
+* @param a The first value
+* @param b The second value
+* @return A new value with the product of a and b
+*/
+bigint_rns bigint_rns_mul(bigint_rns_base base, bigint_rns a, bigint_rns b) {
+    return bigint_rns_apply(BIGINT_RNS_MUL, base, a, b);
+}
+
+/* Convert a bigint to residue number system form
+* @param base The residue number system base
+* @param n The bigint to convert, with |n| at most half the base's modulus
+* @return A new value with the residues of n
+*/
+bigint_rns bigint_rns_from_bigint(bigint_rns_base base, bigint n) {
+    bigint_rns result;
+    result.count = base.count;
+    result.residues = calloc(base.count, sizeof(uint64_t));
+
+    // Horner's rule over chunks of up to 9 decimal digits
+    size_t i = 0;
+    while (i < n.size) {
+        size_t len = (n.size - i) % 9 ? (n.size - i) % 9 : 9;
+        uint64_t chunk = 0, scale = 1;
+        for (size_t j = 0; j < len; j++) {
+            chunk = chunk * 10 + n.digits[i + j];
+            scale *= 10;
+        }
+        for (size_t c = 0; c < base.count; c++) {
+            result.residues[c] = (result.residues[c] * scale + chunk) % base.primes[c];
+        }
+        i += len;
+    }
+
+    if (n.is_negative) {
+        for (size_t c = 0; c < base.count; c++) {
+            if (result.residues[c] != 0) {
+                result.residues[c] = base.primes[c] - result.residues[c];
+            }
+        }
+    }
+    return result;
+}
+
+/* Convert a bigint from residue number system form
+* Uses mixed-radix conversion, so only word-sized arithmetic is needed
+* before the final Horner evaluation.
+* @param base The residue number system base
+* @param x The value to convert
+* @return A new bigint with the value of x, in (-modulus / 2, modulus / 2]
+*/
+bigint bigint_rns_to_bigint(bigint_rns_base base, bigint_rns x) {
+    assert(base.count > 0);
+    // Find the mixed-radix digits v with x = v0 + v1 p0 + v2 p0 p1 + ...
+    uint64_t *v = calloc(base.count, sizeof(uint64_t));
+    for (size_t j = 0; j < base.count; j++) {
+        uint64_t pj = base.primes[j];
+        uint64_t t = x.residues[j];
+        for (size_t i = 0; i < j; i++) {
+            t = (t + pj - v[i] % pj) % pj * base.inverses[i * base.count + j] % pj;
+        }
+        v[j] = t;
+    }
+
+    bigint result = bigint_from_int((int64_t)v[base.count - 1]);
+    for (size_t j = base.count - 1; j > 0; j--) {
+        bigint_mul_ui_inplace(&result, base.primes[j - 1]);
+        bigint_add_ui_inplace(&result, v[j - 1]);
+    }
+    free(v);
+
+    // Map the upper half of the range to negative values
+    if (bigint_gt(result, base.half)) {
+        bigint tmp1 = result;
+        result = bigint_sub(result, base.modulus);
+        bigint_delete(tmp1);
+    }
+    return result;
+}
+
+/* Advance a splitmix64 random number generator
+* @param state The generator state, which may be seeded with any value
+* @return The next 64 random bits
+*/
+uint64_t bigint_random_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Create a random bigint
+* @param bits The number of random bits
+* @param state The random number generator state
+* @return A new bigint uniformly distributed in [0, 2^bits)
+*/
+bigint bigint_random_bits(size_t bits, uint64_t *state) {
+    size_t count = (bits + 31) / 32;
+    uint32_t *words = malloc((count + 1) * sizeof(uint32_t));
+    for (size_t w = 0; w < count; w++) {
+        words[w] = (uint32_t)(bigint_random_next(state) >> 32);
+    }
+    if (bits % 32 != 0) {
+        words[count - 1] &= ((uint32_t)1 << (bits % 32)) - 1;
+    }
+    bigint result = bigint_from_words(words, count, false);
+    free(words);
+    return result;
+}
+
+// Trial division by the primes up to this bound before Miller-Rabin
+#define BIGINT_TRIAL_DIVISION_LIMIT 1000
+
+// Miller-Rabin test that gives up early once *cancel drops below index
+bool bigint_miller_rabin(bigint n, int reps, const size_t *cancel, size_t index, void *lock);
+
+/* Test whether a bigint is probably prime
+* Trial division by small primes is followed by Miller-Rabin rounds. The
+* first twelve rounds use the prime bases 2 through 37, which is
+* deterministic below 3.1 * 10^23; further rounds use random bases.
+* @param n The bigint to test
+* @param reps The number of Miller-Rabin rounds
+* @return Whether n is probably prime
+*/
+bool bigint_probab_prime_p(bigint n, int reps) {
+    return bigint_miller_rabin(n, reps, NULL, 0, NULL);
+}
+
+#ifdef BIGINT_THREADS
+// Read a cancellation index under its lock
+size_t bigint_read_cancel(const size_t *cancel, void *lock) {
+    pthread_mutex_lock(lock);
+    size_t result = *cancel;
+    pthread_mutex_unlock(lock);
+    return result;
+}
+#endif
+
+bool bigint_miller_rabin(bigint n, int reps, const size_t *cancel, size_t index, void *lock) {
+    if (bigint_cmp_si(n, 2) < 0) {
+        return false;
+    }
+    size_t count;
+    uint64_t *primes = bigint_primes_up_to(BIGINT_TRIAL_DIVISION_LIMIT, &count);
+    for (size_t i = 0; i < count; i++) {
+        if (bigint_divisible_ui_p(n, primes[i])) {
+            bool result = bigint_cmp_si(n, (int64_t)primes[i]) == 0;
+            free(primes);
+            return result;
+        }
+    }
+    if (bigint_cmp_si(n, BIGINT_TRIAL_DIVISION_LIMIT * BIGINT_TRIAL_DIVISION_LIMIT) < 0) {
+        free(primes);
+        return true;
+    }
+
+    // n - 1 = d * 2^s with d odd
+    bigint n_minus_1 = bigint_sub_ui(n, 1);
+    size_t s = bigint_scan1(n_minus_1, 0);
+    bigint d = bigint_shr(n_minus_1, s);
+    bigint_modctx ctx = bigint_modctx_new(n);
+    uint64_t state = 0x2545f4914f6cdd1dULL;
+
+    bool result = true;
+    for (int round = 0; round < reps && result; round++) {
+#ifdef BIGINT_THREADS
+        if (cancel != NULL && bigint_read_cancel(cancel, lock) < index) {
+            result = false;
+            break;
+        }
+#else
+        (void)cancel;
+        (void)index;
+        (void)lock;
+#endif
+        bigint a;
+        if (round < 12) {
+            a = bigint_from_int((int64_t)primes[round]);
+        } else {
+            // A random base in [2, n - 2]
+            bigint r = bigint_random_bits(bigint_bit_length(n) + 64, &state);
+            bigint range = bigint_sub_ui(n, 3);
+            a = bigint_mod(r, range);
+            bigint_add_ui_inplace(&a, 2);
+            bigint_delete(range);
+            bigint_delete(r);
+        }
+
+        bigint x = bigint_modctx_pow(ctx, a, d);
+        bigint_delete(a);
+        if (bigint_cmp_si(x, 1) != 0 && !bigint_eq(x, n_minus_1)) {
+            result = false;
+            for (size_t i = 1; i < s; i++) {
+                bigint tmp = x;
+                x = bigint_modmul(ctx, x, x);
+                bigint_delete(tmp);
+                if (bigint_eq(x, n_minus_1)) {
+                    result = true;
+                    break;
+                }
+            }
+        }
+        bigint_delete(x);
+    }
+
+    free(primes);
+    bigint_delete(n_minus_1);
+    bigint_delete(d);
+    bigint_modctx_delete(ctx);
+    return result;
+}
+
+// Primes up to this bound sieve each candidate window
+#ifndef BIGINT_SIEVE_LIMIT
+#define BIGINT_SIEVE_LIMIT 65536
+#endif
+
+// The number of odd candidates in each sieve window
+#ifndef BIGINT_SIEVE_WINDOW
+#define BIGINT_SIEVE_WINDOW 4096
+#endif
+
+// The number of Miller-Rabin rounds used by bigint_nextprime
+#define BIGINT_PRIME_REPS 25
+
+typedef struct {
+    bigint start;
+    const size_t *survivors;
+    size_t count;
+    // The next survivor to test
+    size_t next;
+    // The index of the first survivor found prime, or count
+    size_t best;
+#ifdef BIGINT_THREADS
+    pthread_mutex_t lock;
+#endif
+} bigint_prime_search;
+
+// Test survivors in order until one is prime or a smaller one already was
+void *bigint_prime_search_worker(void *arg) {
+    bigint_prime_search *search = arg;
+    while (true) {
+        size_t i;
+#ifdef BIGINT_THREADS
+        pthread_mutex_lock(&search->lock);
+        i = search->next < search->best ? search->next++ : search->count;
+        pthread_mutex_unlock(&search->lock);
+        void *lock = &search->lock;
+#else
+        i = search->next < search->best ? search->next++ : search->count;
+        void *lock = NULL;
+#endif
+        if (i >= search->count) {
+            return NULL;
+        }
+        bigint candidate = bigint_copy(search->start);
+        bigint_add_ui_inplace(&candidate, 2 * search->survivors[i]);
+        bool prime = bigint_miller_rabin(candidate, BIGINT_PRIME_REPS, &search->best, i, lock);
+        bigint_delete(candidate);
+        if (prime) {
+#ifdef BIGINT_THREADS
+            pthread_mutex_lock(&search->lock);
+#endif
+            if (i < search->best) {
+                search->best = i;
+            }
+#ifdef BIGINT_THREADS
+            pthread_mutex_unlock(&search->lock);
+#endif
+        }
+    }
+}
+
+#ifdef BIGINT_THREADS
+// Run one of the workers of a prime search as a part of a pool job
+void bigint_prime_search_part(void *arg, size_t part, size_t parts) {
+    (void)part;
+    (void)parts;
+    bigint_prime_search_worker(arg);
+}
+#endif
+
+/* Find the next prime
+* Windows of odd candidates are sieved by the primes up to
+* BIGINT_SIEVE_LIMIT, keeping each prime's residue up to date as the
+* window moves. Survivors are tested with Miller-Rabin; with
+* BIGINT_THREADS defined, every thread of the worker pool tests them at
+* once and stops as soon as a smaller candidate is known to be prime.
+* @param n The bigint to start after
+* @return A new bigint with the smallest probable prime greater than n
+*/
+bigint bigint_nextprime(bigint n) {
+    if (bigint_cmp_si(n, 2) < 0) {
+        return bigint_from_int(2);
+    }
+
+    // Start at the first odd number above n
+    bigint start = bigint_add_ui(n, 1);
+    if (bigint_is_even(start)) {
+        bigint_inc(&start);
+    }
+
+    size_t prime_count;
+    uint64_t *primes = bigint_primes_up_to(BIGINT_SIEVE_LIMIT, &prime_count);
+    uint64_t *residues = malloc(prime_count * sizeof(uint64_t));
+    for (size_t i = 1; i < prime_count; i++) {
+        residues[i] = bigint_mod_ui(start, primes[i]);
+    }
+    bool small = bigint_cmp_si(start, BIGINT_SIEVE_LIMIT) <= 0;
+
+    char *composite = malloc(BIGINT_SIEVE_WINDOW);
+    size_t *survivors = malloc(BIGINT_SIEVE_WINDOW * sizeof(size_t));
+    bigint result;
+    while (true) {
+        // Candidate j is start + 2j; skip the even prime
+        memset(composite, 0, BIGINT_SIEVE_WINDOW);
+        for (size_t i = 1; i < prime_count; i++) {
+            uint64_t p = primes[i];
+            // Solve start + 2j = 0 mod p
+            uint64_t j = (p - residues[i]) % p * ((p + 1) / 2) % p;
+            for (; j < BIGINT_SIEVE_WINDOW; j += p) {
+                composite[j] = 1;
+            }
+        }
+        if (small) {
+            // The sieving primes themselves are not composite
+            int64_t first = bigint_to_int(start);
+            for (size_t i = 1; i < prime_count; i++) {
+                if ((int64_t)primes[i] >= first && ((int64_t)primes[i] - first) / 2 < BIGINT_SIEVE_WINDOW) {
+                    composite[(primes[i] - first) / 2] = 0;
+                }
+            }
+        }
+
+        size_t count = 0;
+        for (size_t j = 0; j < BIGINT_SIEVE_WINDOW; j++) {
+            if (!composite[j]) {
+                survivors[count++] = j;
+            }
+        }
+
+        bigint_prime_search search;
+        search.start = start;
+        search.survivors = survivors;
+        search.count = count;
+        search.next = 0;
+        search.best = count;
+#ifdef BIGINT_THREADS
+        pthread_mutex_init(&search.lock, NULL);
+        bigint_pool_run(bigint_prime_search_part, &search, bigint_pool_size());
+        pthread_mutex_destroy(&search.lock);
+#else
+        bigint_prime_search_worker(&search);
+#endif
+
+        if (search.best < count) {
+            result = bigint_add_ui(start, 2 * survivors[search.best]);
+            break;
+        }
+
+        // Move the window and its residues along
+        bigint_add_ui_inplace(&start, 2 * BIGINT_SIEVE_WINDOW);
+        for (size_t i = 1; i < prime_count; i++) {
+            residues[i] = (residues[i] + 2 * BIGINT_SIEVE_WINDOW) % primes[i];
+        }
+        small = false;
+    }
+
+    free(composite);
+    free(survivors);
+    free(primes);
+    free(residues);
+    bigint_delete(start);
+    return result;
+}
+
+/* Create a random prime
+* @param bits The number of bits of the prime, at least 2
+* @param state The random number generator state
+* @return A new bigint with a random probable prime in [2^(bits - 1), 2^bits)
+*/
+bigint bigint_random_prime(size_t bits, uint64_t *state) {
+    assert(bits >= 2);
+    while (true) {
+        bigint candidate = bigint_random_bits(bits, state);
+        bigint_setbit(&candidate, bits - 1);
+        bigint_dec(&candidate);
+        bigint result = bigint_nextprime(candidate);
+        bigint_delete(candidate);
+        if (bigint_bit_length(result) == bits) {
+            return result;
+        }
+        bigint_delete(result);
+    }
+}
+
+/* Integer factorization
+* Small factors are removed by trial division. Composite cofactors are
+* then split by Pollard's rho (with Brent's cycle detection), Pollard's
+* p-1 and the elliptic curve method on Montgomery curves. With
+* BIGINT_THREADS defined, the methods race each other on separate threads
+* and the first factor found cancels the rest.
+*/
+
+// Trial division by the primes up to this bound
+#ifndef BIGINT_FACTOR_TRIAL_LIMIT
+#define BIGINT_FACTOR_TRIAL_LIMIT 10000
+#endif
+
+// The number of steps between the gcds taken by rho, p-1 and ECM
+#define BIGINT_FACTOR_BATCH 64
+
+// Shared state for methods racing to find a factor
+typedef struct {
+    bool found;
+    bigint factor;
+#ifdef BIGINT_THREADS
+    pthread_mutex_t lock;
+#endif
+} bigint_factor_search;
+
+// Whether another method has already found a factor
+bool bigint_factor_stopped(bigint_factor_search *search) {
+    if (search == NULL) {
+        return false;
+    }
+#ifdef BIGINT_THREADS
+    pthread_mutex_lock(&search->lock);
+    bool result = search->found;
+    pthread_mutex_unlock(&search->lock);
+    return result;
+#else
+    return search->found;
+#endif
+}
+
+// Check whether g = gcd(x, n) is a proper factor of n; takes ownership of g
+bool bigint_factor_check(bigint g, bigint n, bigint *factor) {
+    if (bigint_cmp_si(g, 1) > 0 && bigint_lt(g, n)) {
+        *factor = g;
+        return true;
+    }
+    bigint_delete(g);
+    return false;
+}
+
+// y = y^2 + c mod n
+void bigint_rho_step(bigint_modctx ctx, bigint *y, bigint c) {
+    bigint square = bigint_modmul(ctx, *y, *y);
+    bigint_delete(*y);
+    *y = bigint_modadd(ctx, square, c);
+    bigint_delete(square);
+}
+
+bigint bigint_rho_search(bigint n, uint64_t iterations, uint64_t seed, bigint_factor_search *search) {
+    bigint_modctx ctx = bigint_modctx_new(n);
+    uint64_t state = seed;
+    bigint c = bigint_from_int(1 + bigint_random_next(&state) % 1000000);
+    bigint start = bigint_from_int(2 + bigint_random_next(&state) % 1000000);
+    bigint y = bigint_modred(ctx, start);
+    bigint_delete(start);
+    bigint x = bigint_copy(y), ys = bigint_copy(y), q = bigint_from_int(1), g = bigint_from_int(1);
+    bigint diff, tmp;
+
+    uint64_t r = 1, steps = 0;
+    while (bigint_cmp_si(g, 1) == 0 && steps < iterations && !bigint_factor_stopped(search)) {
+        bigint_delete(x);
+        x = bigint_copy(y);
+        for (uint64_t i = 0; i < r; i++) {
+            bigint_rho_step(ctx, &y, c);
+        }
+        steps += r;
+
+        // Batch the differences into one product per gcd
+        for (uint64_t k = 0; k < r && bigint_cmp_si(g, 1) == 0; k += BIGINT_FACTOR_BATCH) {
+            bigint_delete(ys);
+            ys = bigint_copy(y);
+            for (uint64_t i = 0; i < BIGINT_FACTOR_BATCH && i < r - k; i++) {
+                bigint_rho_step(ctx, &y, c);
+                diff = bigint_modsub(ctx, x, y);
+                tmp = q;
+                q = bigint_modmul(ctx, q, diff);
+                bigint_delete(tmp);
+                bigint_delete(diff);
+            }
+            bigint_delete(g);
+            g = bigint_gcd(q, n);
+            steps += BIGINT_FACTOR_BATCH;
+        }
+        r *= 2;
+    }
+
+    // The batch overshot: step back one difference at a time
+    if (bigint_eq(g, n)) {
+        do {
+            bigint_rho_step(ctx, &ys, c);
+            diff = bigint_modsub(ctx, x, ys);
+            bigint_delete(g);
+            g = bigint_gcd(diff, n);
+            bigint_delete(diff);
+        } while (bigint_cmp_si(g, 1) == 0);
+    }
+
+    bigint factor;
+    if (!bigint_factor_check(g, n, &factor)) {
+        factor = bigint_zero();
+    }
+    bigint_delete(c);
+    bigint_delete(x);
+    bigint_delete(y);
+    bigint_delete(ys);
+    bigint_delete(q);
+    bigint_modctx_delete(ctx);
+    return factor;
+}
+
+/* Search for a factor with Pollard's rho method
+* @param n The composite to factor
+* @param iterations The most iterations to try
+* @param seed The seed that picks the polynomial and starting point
+* @return A new bigint with a proper factor of n, or zero if none was found
+*/
+bigint bigint_factor_rho(bigint n, uint64_t iterations, uint64_t seed) {
+    return bigint_rho_search(n, iterations, seed, NULL);
+}
+
+// The largest gap between consecutive primes that p-1 stage 2 can step over
+#define BIGINT_MAX_PRIME_GAP 512
+
+bigint bigint_pm1_search(bigint n, uint64_t b1, uint64_t b2, bigint_factor_search *search) {
+    bigint_modctx ctx = bigint_modctx_new(n);
+    size_t count;
+    uint64_t *primes = bigint_primes_up_to(b2 > b1 ? b2 : b1, &count);
+    bigint a = bigint_from_int(2), factor, g, tmp, exponent;
+
+    // Stage 1: a = 2^E, where E is the product of the prime powers up to b1
+    uint64_t batch = 1;
+    size_t i = 0;
+    for (; i <= count; i++) {
+        uint64_t power = 0;
+        if (i < count && primes[i] <= b1) {
+            power = primes[i];
+            while (power <= b1 / primes[i]) {
+                power *= primes[i];
+            }
+        }
+        if (power == 0 || batch > INT64_MAX / power) {
+            exponent = bigint_from_int((int64_t)batch);
+            tmp = a;
+            a = bigint_modctx_pow(ctx, a, exponent);
+            bigint_delete(tmp);
+            bigint_delete(exponent);
+            batch = 1;
+        }
+        if (power == 0) {
+            break;
+        }
+        batch *= power;
+    }
+    tmp = bigint_sub_ui(a, 1);
+    g = bigint_gcd(tmp, n);
+    bigint_delete(tmp);
+    bool found = bigint_factor_check(g, n, &factor);
+
+    // Stage 2: one more prime q in (b1, b2], stepping between primes with a table of a^gap
+    if (!found && i < count) {
+        bigint gaps[BIGINT_MAX_PRIME_GAP / 2];
+        memset(gaps, 0, sizeof(gaps));
+        exponent = bigint_from_int((int64_t)primes[i]);
+        bigint x = bigint_modctx_pow(ctx, a, exponent);
+        bigint_delete(exponent);
+        bigint acc = bigint_from_int(1);
+        for (size_t j = i; j < count && !found; j++) {
+            if (j > i) {
+                uint64_t gap = primes[j] - primes[j - 1];
+                assert(gap < BIGINT_MAX_PRIME_GAP);
+                if (gaps[gap / 2].digits == NULL) {
+                    exponent = bigint_from_int((int64_t)gap);
+                    gaps[gap / 2] = bigint_modctx_pow(ctx, a, exponent);
+                    bigint_delete(exponent);
+                }
+                tmp = x;
+                x = bigint_modmul(ctx, x, gaps[gap / 2]);
+                bigint_delete(tmp);
+            }
+            bigint x_minus_1 = bigint_sub_ui(x, 1);
+            tmp = acc;
+            acc = bigint_modmul(ctx, acc, x_minus_1);
+            bigint_delete(tmp);
+            bigint_delete(x_minus_1);
+            if ((j - i) % BIGINT_FACTOR_BATCH == BIGINT_FACTOR_BATCH - 1 || j == count - 1) {
+                g = bigint_gcd(acc, n);
+                found = bigint_factor_check(g, n, &factor);
+                if (bigint_factor_stopped(search)) {
+                    break;
+                }
+            }
+        }
+        for (size_t j = 0; j < BIGINT_MAX_PRIME_GAP / 2; j++) {
+            if (gaps[j].digits != NULL) {
+                bigint_delete(gaps[j]);
+            }
+        }
+        bigint_delete(x);
+        bigint_delete(acc);
+    }
+
+    if (!found) {
+        factor = bigint_zero();
+    }
+    free(primes);
+    bigint_delete(a);
+    bigint_modctx_delete(ctx);
+    return factor;
+}
+
+/* Search for a factor with Pollard's p-1 method
+* @param n The composite to factor
+* @param b1 The stage 1 bound
+* @param b2 The stage 2 bound
+* @return A new bigint with a proper factor of n, or zero if none was found
+*/
+bigint bigint_factor_pm1(bigint n, uint64_t b1, uint64_t b2) {
+    return bigint_pm1_search(n, b1, b2, NULL);
+}
+
+// A point on a Montgomery curve in projective X:Z coordinates
+typedef struct {
+    bigint x;
+    bigint z;
+} bigint_ecm_point;
+
+void bigint_ecm_point_delete(bigint_ecm_point p) {
+    bigint_delete(p.x);
+    bigint_delete(p.z);
+}
+
+bigint_ecm_point bigint_ecm_point_copy(bigint_ecm_point p) {
+    bigint_ecm_point result = {bigint_copy(p.x), bigint_copy(p.z)};
+    return result;
+}
+
+// [2]P, where a24 = (A + 2) / 4
+bigint_ecm_point bigint_ecm_double(bigint_modctx ctx, bigint_ecm_point p, bigint a24) {
+    bigint s = bigint_modadd(ctx, p.x, p.z), d = bigint_modsub(ctx, p.x, p.z);
+    bigint s2 = bigint_modmul(ctx, s, s), d2 = bigint_modmul(ctx, d, d);
+    bigint t = bigint_modsub(ctx, s2, d2);
+    bigint u = bigint_modmul(ctx, a24, t);
+    bigint v = bigint_modadd(ctx, d2, u);
+    bigint_ecm_point result = {bigint_modmul(ctx, s2, d2), bigint_modmul(ctx, t, v)};
+    bigint_delete(s);
+    bigint_delete(d);
+    bigint_delete(s2);
+    bigint_delete(d2);
+    bigint_delete(t);
+    bigint_delete(u);
+    bigint_delete(v);
+    return result;
+}
+
+// P + Q, given P - Q
+bigint_ecm_point bigint_ecm_add(bigint_modctx ctx, bigint_ecm_point p, bigint_ecm_point q, bigint_ecm_point diff) {
+    bigint a = bigint_modsub(ctx, p.x, p.z), b = bigint_modadd(ctx, q.x, q.z);
+    bigint c = bigint_modadd(ctx, p.x, p.z), d = bigint_modsub(ctx, q.x, q.z);
+    bigint u = bigint_modmul(ctx, a, b), v = bigint_modmul(ctx, c, d);
+    bigint sum = bigint_modadd(ctx, u, v), difference = bigint_modsub(ctx, u, v);
+    bigint sum2 = bigint_modmul(ctx, sum, sum), difference2 = bigint_modmul(ctx, difference, difference);
+    bigint_ecm_point result = {bigint_modmul(ctx, diff.z, sum2), bigint_modmul(ctx, diff.x, difference2)};
+    bigint_delete(a);
+    bigint_delete(b);
+    bigint_delete(c);
+    bigint_delete(d);
+    bigint_delete(u);
+    bigint_delete(v);
+    bigint_delete(sum);
+    bigint_delete(difference);
+    bigint_delete(sum2);
+    bigint_delete(difference2);
+    return result;
+}
+
+// [k]P by the Montgomery ladder, for k >= 1
+bigint_ecm_point bigint_ecm_multiply(bigint_modctx ctx, bigint_ecm_point p, uint64_t k, bigint a24) {
+    bigint_ecm_point r0 = bigint_ecm_point_copy(p), r1 = bigint_ecm_double(ctx, p, a24), tmp;
+    int bit = 63;
+    while (!((k >> bit) & 1)) {
+        bit--;
+    }
+    for (bit--; bit >= 0; bit--) {
+        if ((k >> bit) & 1) {
+            tmp = r0;
+            r0 = bigint_ecm_add(ctx, r1, r0, p);
+            bigint_ecm_point_delete(tmp);
+            tmp = r1;
+            r1 = bigint_ecm_double(ctx, r1, a24);
+            bigint_ecm_point_delete(tmp);
+        } else {
+            tmp = r1;
+            r1 = bigint_ecm_add(ctx, r1, r0, p);
+            bigint_ecm_point_delete(tmp);
+            tmp = r0;
+            r0 = bigint_ecm_double(ctx, r0, a24);
+            bigint_ecm_point_delete(tmp);
+        }
+    }
+    bigint_ecm_point_delete(r1);
+    return r0;
+}
+
+// The giant step of ECM stage 2, a product of small primes
+#define BIGINT_ECM_STAGE2_D 2310
+
+// One ECM curve with Suyama's parametrization; returns true if *factor was set
+bool bigint_ecm_curve(bigint_modctx ctx, bigint n, uint64_t sigma_value, const uint64_t *primes, size_t count, uint64_t b1, bigint *factor, bigint_factor_search *search) {
+    // u = sigma^2 - 5, v = 4 sigma, x0 = u^3, z0 = v^3
+    bigint sigma = bigint_from_int((int64_t)sigma_value);
+    bigint tmp = bigint_modmul(ctx, sigma, sigma);
+    bigint u = bigint_sub_ui(tmp, 5);
+    bigint_delete(tmp);
+    bigint v = bigint_mul_ui(sigma, 4);
+    bigint_delete(sigma);
+    bigint u2 = bigint_modmul(ctx, u, u), v2 = bigint_modmul(ctx, v, v);
+    bigint_ecm_point p = {bigint_modmul(ctx, u2, u), bigint_modmul(ctx, v2, v)};
+
+    // a24 = (v - u)^3 (3u + v) / (16 u^3 v)
+    bigint w = bigint_modsub(ctx, v, u);
+    bigint w2 = bigint_modmul(ctx, w, w);
+    bigint w3 = bigint_modmul(ctx, w2, w);
+    bigint t = bigint_mul_ui(u, 3);
+    tmp = bigint_add(t, v);
+    bigint num = bigint_modmul(ctx, w3, tmp);
+    bigint_delete(tmp);
+    bigint_delete(t);
+    tmp = bigint_mul_ui(p.x, 16);
+    bigint den = bigint_modmul(ctx, tmp, v);
+    bigint_delete(tmp);
+    bigint inverse = bigint_modinv(den, n);
+    bool found = false;
+    bigint a24 = bigint_zero();
+    if (bigint_eqzero(inverse)) {
+        // The denominator shares a factor with n
+        found = bigint_factor_check(bigint_gcd(den, n), n, factor);
+    } else {
+        bigint_delete(a24);
+        a24 = bigint_modmul(ctx, num, inverse);
+    }
+    bigint_delete(u);
+    bigint_delete(v);
+    bigint_delete(u2);
+    bigint_delete(v2);
+    bigint_delete(w);
+    bigint_delete(w2);
+    bigint_delete(w3);
+    bigint_delete(num);
+    bigint_delete(den);
+    bigint_delete(inverse);
+    if (bigint_eqzero(a24)) {
+        bigint_ecm_point_delete(p);
+        bigint_delete(a24);
+        return found;
+    }
+
+    // Stage 1: multiply by every prime power up to b1
+    size_t i = 0;
+    bigint_ecm_point q;
+    // Primes below D / 2 are too small for stage 2, so they join stage 1
+    for (; i < count && (primes[i] <= b1 || primes[i] < BIGINT_ECM_STAGE2_D / 2); i++) {
+        uint64_t power = primes[i];
+        while (power <= b1 / primes[i]) {
+            power *= primes[i];
+        }
+        q = bigint_ecm_multiply(ctx, p, power, a24);
+        bigint_ecm_point_delete(p);
+        p = q;
+        if (i % BIGINT_FACTOR_BATCH == 0 && bigint_factor_stopped(search)) {
+            bigint_ecm_point_delete(p);
+            bigint_delete(a24);
+            return false;
+        }
+    }
+    found = bigint_factor_check(bigint_gcd(p.z, n), n, factor);
+
+    // Stage 2: one more prime q = mD +- j in (b1, b2]. [q]P vanishes mod p exactly when
+    // [mD]P and [j]P share an x-coordinate mod p, so multiply up X_R Z_j - X_j Z_R
+    if (!found && i < count && !bigint_eqzero(p.z)) {
+        size_t babies = BIGINT_ECM_STAGE2_D / 4;
+        bigint_ecm_point *baby = malloc(babies * sizeof(bigint_ecm_point));
+        bigint_ecm_point p2 = bigint_ecm_double(ctx, p, a24);
+        // baby[k] = [2k + 1]P
+        baby[0] = bigint_ecm_point_copy(p);
+        baby[1] = bigint_ecm_add(ctx, p2, p, p);
+        for (size_t k = 2; k < babies; k++) {
+            baby[k] = bigint_ecm_add(ctx, baby[k - 1], p2, baby[k - 2]);
+        }
+
+        // r = [mD]P and next = [(m + 1)D]P, for the giant step nearest the first prime
+        uint64_t m = (primes[i] + BIGINT_ECM_STAGE2_D / 2) / BIGINT_ECM_STAGE2_D;
+        bigint_ecm_point giant = bigint_ecm_multiply(ctx, p, BIGINT_ECM_STAGE2_D, a24);
+        bigint_ecm_point r = bigint_ecm_multiply(ctx, p, m * BIGINT_ECM_STAGE2_D, a24);
+        bigint_ecm_point next = bigint_ecm_multiply(ctx, p, (m + 1) * BIGINT_ECM_STAGE2_D, a24);
+
+        bigint acc = bigint_from_int(1);
+        for (size_t steps = 0; i < count && !found; steps++) {
+            uint64_t center = m * BIGINT_ECM_STAGE2_D;
+            for (; i < count && primes[i] < center + BIGINT_ECM_STAGE2_D / 2; i++) {
+                uint64_t j = primes[i] > center ? primes[i] - center : center - primes[i];
+                bigint_ecm_point s = baby[j / 2];
+                bigint xz = bigint_modmul(ctx, r.x, s.z), zx = bigint_modmul(ctx, s.x, r.z);
+                bigint difference = bigint_modsub(ctx, xz, zx);
+                tmp = acc;
+                acc = bigint_modmul(ctx, acc, difference);
+                bigint_delete(tmp);
+                bigint_delete(xz);
+                bigint_delete(zx);
+                bigint_delete(difference);
+            }
+            if (steps % BIGINT_FACTOR_BATCH == BIGINT_FACTOR_BATCH - 1 || i == count) {
+                found = bigint_factor_check(bigint_gcd(acc, n), n, factor);
+                if (bigint_factor_stopped(search)) {
+                    break;
+                }
+            }
+
+            q = bigint_ecm_add(ctx, next, giant, r);
+            bigint_ecm_point_delete(r);
+            r = next;
+            next = q;
+            m++;
+        }
+        for (size_t k = 0; k < babies; k++) {
+            bigint_ecm_point_delete(baby[k]);
+        }
+        free(baby);
+        bigint_ecm_point_delete(p2);
+        bigint_ecm_point_delete(giant);
+        bigint_ecm_point_delete(r);
+        bigint_ecm_point_delete(next);
+        bigint_delete(acc);
+    }
+    bigint_ecm_point_delete(p);
+    bigint_delete(a24);
+    return found;
+}
+
+bigint bigint_ecm_search(bigint n, uint64_t b1, uint64_t b2, size_t curves, uint64_t seed, bigint_factor_search *search) {
+    bigint_modctx ctx = bigint_modctx_new(n);
+    size_t count;
+    uint64_t *primes = bigint_primes_up_to(b2 > b1 ? b2 : b1, &count);
+    uint64_t state = seed;
+    bigint factor = bigint_zero();
+    for (size_t curve = 0; curve < curves && !bigint_factor_stopped(search); curve++) {
+        uint64_t sigma = 6 + bigint_random_next(&state) % 2147483642;
+        bigint found;
+        if (bigint_ecm_curve(ctx, n, sigma, primes, count, b1, &found, search)) {
+            bigint_delete(factor);
+            factor = found;
+            break;
+        }
     }
+    free(primes);
+    bigint_modctx_delete(ctx);
+    return factor;
+}
 
-    bigint remainder;
-    bigint_delete(bigint_divmod(a, b, &remainder));
-    return remainder;
+/* Search for a factor with the elliptic curve method
+* @param n The composite to factor, with no factors of 2 or 3
+* @param b1 The stage 1 bound
+* @param b2 The stage 2 bound
+* @param curves The number of curves to try
+* @param seed The seed that picks the curves
+* @return A new bigint with a proper factor of n, or zero if none was found
+*/
+bigint bigint_factor_ecm(bigint n, uint64_t b1, uint64_t b2, size_t curves, uint64_t seed) {
+    return bigint_ecm_search(n, b1, b2, curves, seed, NULL);
 }
 
-bigint bigint_pow(bigint a, bigint b) {
-    bigint result, tmp;
-    if (b.is_negative) {
-        result = bigint_from_string("0");
-        return result;
-    }
-    result = bigint_from_string("1");
-    if (bigint_eqzero(b)) {
-        return result;
-    }
-    b = bigint_copy(b);
-    while (!bigint_eqzero(b)) {
-        tmp = result;
-        result = bigint_mul(result, a);
-        bigint_delete(tmp);
-        bigint_dec(&b);
+// ECM bounds and curve counts, each level aimed at factors about 5 digits larger
+typedef struct {
+    uint64_t b1;
+    size_t curves;
+} bigint_ecm_level;
+
+const bigint_ecm_level bigint_ecm_levels[] = {
+    {2000, 25},
+    {11000, 90},
+    {50000, 300},
+    {250000, 700},
+    {1000000, 1800},
+};
+
+#define BIGINT_ECM_LEVELS (sizeof(bigint_ecm_levels) / sizeof(bigint_ecm_levels[0]))
+
+// Report a factor to the search, keeping the first one found
+void bigint_factor_report(bigint_factor_search *search, bigint factor) {
+#ifdef BIGINT_THREADS
+    pthread_mutex_lock(&search->lock);
+#endif
+    if (!search->found && !bigint_eqzero(factor)) {
+        search->found = true;
+        search->factor = factor;
+    } else {
+        bigint_delete(factor);
     }
-    bigint_delete(b);
-    return result;
+#ifdef BIGINT_THREADS
+    pthread_mutex_unlock(&search->lock);
+#endif
 }
 
-bool bigint_is_odd(bigint n);
-bool bigint_is_even(bigint n);
+typedef struct {
+    bigint n;
+    bigint_factor_search *search;
+    // 0 runs rho, anything else runs p-1 and ECM with its own seed
+    size_t worker;
+    size_t workers;
+} bigint_factor_task;
 
-bigint bigint_fast_pow(bigint a, bigint b, bigint m) {
-    if (bigint_is_64_bit(a) && bigint_is_64_bit(b) && bigint_is_64_bit(m)) {
-        int64_t result = 1;
-        int64_t base = bigint_to_int(a);
-        int64_t exp = bigint_to_int(b);
-        int64_t mod = bigint_to_int(m);
-        base %= mod;
-        while (exp > 0) {
-            if (exp % 2 == 1) {
-                result = (result * base) % mod;
+void *bigint_factor_worker(void *arg) {
+    bigint_factor_task *task = arg;
+    bigint n = task->n;
+    bigint_factor_search *search = task->search;
+    if (task->worker == 0) {
+        // Rho finds small factors quickly; with other workers it runs until cancelled
+        uint64_t iterations = task->workers > 1 ? UINT64_MAX : 1 << 16;
+        for (uint64_t seed = 1; !bigint_factor_stopped(search); seed++) {
+            bigint_factor_report(search, bigint_rho_search(n, iterations, seed, search));
+            if (task->workers == 1) {
+                break;
             }
-            exp = exp >> 1;
-            base = (base * base) % mod;
         }
-        return bigint_from_int(result);
+        if (task->workers > 1) {
+            return NULL;
+        }
     }
-    
-    bigint result;
 
-    if (b.is_negative) {
-        result = bigint_from_string("0");
-        return result;
+    if (task->worker <= 1 && !bigint_factor_stopped(search)) {
+        bigint_factor_report(search, bigint_pm1_search(n, 100000, 5000000, search));
     }
-    if (bigint_eqzero(b)) {
-        result = bigint_from_string("1");
-        return result;
+    size_t ecm_workers = task->workers > 1 ? task->workers - 1 : 1;
+    for (size_t level = 0; !bigint_factor_stopped(search); level++) {
+        const bigint_ecm_level *ecm = &bigint_ecm_levels[level < BIGINT_ECM_LEVELS ? level : BIGINT_ECM_LEVELS - 1];
+        size_t curves = (ecm->curves + ecm_workers - 1) / ecm_workers;
+        uint64_t seed = level * 1000003 + task->worker;
+        bigint_factor_report(search, bigint_ecm_search(n, ecm->b1, ecm->b1 * 50, curves, seed, search));
     }
+    return NULL;
+}
 
-    bigint tmp1, tmp2;
-    // printf("Computing %lld ^ %lld mod %lld\n", bigint_to_int(a), bigint_to_int(b), bigint_to_int(m));
-    b = bigint_copy(b);
-    a = bigint_mod(a, m);
-    result = bigint_copy(a);
-    bigint b_save = bigint_copy(b);
-    bigint_dec(&b);
-
-    bigint pow = bigint_from_string("1");
-    while (true) {
-        tmp1 = bigint_from_string("2");
-        tmp2 = bigint_div(b, tmp1);
-        bigint_delete(tmp1);
-        if (!bigint_gtzero(tmp2)) {
-            bigint_delete(tmp2);
-            break;
+// Find a proper factor of a composite with no small prime factors
+bigint bigint_find_factor(bigint n) {
+    bigint_factor_search search;
+    search.found = false;
+#ifdef BIGINT_THREADS
+    pthread_mutex_init(&search.lock, NULL);
+    pthread_t threads[BIGINT_THREAD_COUNT];
+    bigint_factor_task tasks[BIGINT_THREAD_COUNT];
+    bool started[BIGINT_THREAD_COUNT];
+    for (size_t t = 0; t < BIGINT_THREAD_COUNT; t++) {
+        bigint_factor_task task = {n, &search, t, BIGINT_THREAD_COUNT};
+        tasks[t] = task;
+        started[t] = t > 0 && pthread_create(&threads[t], NULL, bigint_factor_worker, &tasks[t]) == 0;
+    }
+    bigint_factor_worker(&tasks[0]);
+    for (size_t t = 1; t < BIGINT_THREAD_COUNT; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
         }
-        bigint_delete(tmp2);
+    }
+    pthread_mutex_destroy(&search.lock);
+#else
+    bigint_factor_task task = {n, &search, 0, 1};
+    bigint_factor_worker(&task);
+#endif
+    return search.factor;
+}
 
-        tmp1 = bigint_mul(result, result);
-        tmp2 = result;
-        result = bigint_mod(tmp1, m);
-        bigint_delete(tmp1);
-        bigint_delete(tmp2);
+/* The prime factorization of a bigint */
+typedef struct {
+    // The distinct prime factors, in increasing order
+    bigint *primes;
+    // The exponent of each prime
+    size_t *exponents;
+    size_t count;
+} bigint_factors;
 
-        // Halve b
-        tmp1 = b;
-        tmp2 = bigint_from_string("2");
-        
-        b = bigint_div(b, tmp2);
-        bigint_delete(tmp1);
-        bigint_delete(tmp2);
-        
-        tmp1 = pow;
-        pow = bigint_add(pow, pow);
-        bigint_delete(tmp1);
+// Add a prime factor to a factorization, keeping it sorted
+void bigint_factors_add(bigint_factors *factors, bigint p, size_t exponent) {
+    size_t i = 0;
+    while (i < factors->count && bigint_lt(factors->primes[i], p)) {
+        i++;
     }
-    
-    tmp1 = b_save;
-    b_save = bigint_sub(b_save, pow);
-    bigint_delete(tmp1);
+    if (i < factors->count && bigint_eq(factors->primes[i], p)) {
+        factors->exponents[i] += exponent;
+        bigint_delete(p);
+        return;
+    }
+    factors->primes = realloc(factors->primes, (factors->count + 1) * sizeof(bigint));
+    factors->exponents = realloc(factors->exponents, (factors->count + 1) * sizeof(size_t));
+    memmove(factors->primes + i + 1, factors->primes + i, (factors->count - i) * sizeof(bigint));
+    memmove(factors->exponents + i + 1, factors->exponents + i, (factors->count - i) * sizeof(size_t));
+    factors->primes[i] = p;
+    factors->exponents[i] = exponent;
+    factors->count++;
+}
 
-    if (bigint_is_odd(b_save)) {
-        tmp1 = result;
-        tmp2 = bigint_mul(result, a);
-        result = bigint_mod(tmp2, m);
-        bigint_delete(tmp1);
-        bigint_delete(tmp2);
-        bigint_dec(&b_save);
-        bigint_inc(&pow);
+/* Find the prime factorization of a bigint
+* @param n The bigint to factor; its sign is ignored
+* @return A new factorization, to be freed with bigint_factors_delete
+*/
+bigint_factors bigint_factor(bigint n) {
+    bigint_factors factors = {NULL, NULL, 0};
+    bigint rest = bigint_copy(n);
+    rest.is_negative = false;
+    bigint_normalize(&rest);
+    if (bigint_eqzero(rest)) {
+        bigint_delete(rest);
+        return factors;
     }
 
-    if (bigint_lt(b_save, bigint_from_int(5))) {
-        while (!bigint_eqzero(b_save)) {
-            tmp1 = result;
-            tmp2 = bigint_mul(result, a);
-            result = bigint_mod(tmp2, m);
-            bigint_delete(tmp1);
-            bigint_delete(tmp2);
-            bigint_dec(&b_save);
-            bigint_inc(&pow);
+    // Stage 1: trial division
+    size_t count;
+    uint64_t *primes = bigint_primes_up_to(BIGINT_FACTOR_TRIAL_LIMIT, &count);
+    for (size_t i = 0; i < count && bigint_cmp_si(rest, (int64_t)(primes[i] * primes[i])) >= 0; i++) {
+        size_t exponent = 0;
+        while (bigint_divisible_ui_p(rest, primes[i])) {
+            bigint_divmod_ui_inplace(&rest, primes[i]);
+            exponent++;
         }
+        if (exponent > 0) {
+            factors.primes = realloc(factors.primes, (factors.count + 1) * sizeof(bigint));
+            factors.exponents = realloc(factors.exponents, (factors.count + 1) * sizeof(size_t));
+            factors.primes[factors.count] = bigint_from_int((int64_t)primes[i]);
+            factors.exponents[factors.count++] = exponent;
+        }
+    }
+    free(primes);
 
-        bigint_delete(b_save);
-        bigint_delete(pow);
+    // Stage 2: split the composite cofactors until only primes are left
+    bigint *pending = malloc(sizeof(bigint));
+    size_t pending_count = 0;
+    if (bigint_cmp_si(rest, 1) > 0) {
+        pending[pending_count++] = rest;
+    } else {
+        bigint_delete(rest);
+    }
+    while (pending_count > 0) {
+        bigint c = pending[--pending_count];
+        if (bigint_probab_prime_p(c, BIGINT_PRIME_REPS)) {
+            bigint_factors_add(&factors, c, 1);
+            continue;
+        }
+        bigint f = bigint_find_factor(c);
+        pending = realloc(pending, (pending_count + 2) * sizeof(bigint));
+        pending[pending_count++] = bigint_divexact(c, f);
+        pending[pending_count++] = f;
+        bigint_delete(c);
+    }
+    free(pending);
+    return factors;
+}
 
-        return result;
+/* Delete a factorization
+* @param factors The factorization to delete
+*/
+void bigint_factors_delete(bigint_factors factors) {
+    for (size_t i = 0; i < factors.count; i++) {
+        bigint_delete(factors.primes[i]);
     }
+    free(factors.primes);
+    free(factors.exponents);
+}
 
-    // Do the same halving powers for the subpart
-    bigint subpart = bigint_fast_pow(a, b_save, m);
+#ifdef BIGINT_POSIX
+/* File-backed storage
+* A mapped bigint keeps its digits in a memory-mapped file, laid out as one
+* int64_t holding the sign followed by the digits. Mapped bigints work as
+* operands everywhere, but like constants must not be modified in place.
+* bigint_delete finds their mapping in a registry and unmaps it. The
+* registry keeps its mappings sorted by address, and the count and the
+* bounds of the mapped range can be read without the lock, so freeing a
+* heap bigint only takes the lock when its address falls in that range.
+*/
+typedef struct {
+    char *base;
+    size_t length;
+} bigint_mapping;
 
-    tmp1 = result;
-    tmp2 = subpart;
-    result = bigint_mul(result, subpart);
-    bigint_delete(tmp1);
-    bigint_delete(tmp2);
+typedef struct {
+    bigint_mapping *entries;
+    size_t count;
+    size_t capacity;
+    uintptr_t low, high;
+} bigint_mapping_registry;
 
-    tmp1 = result;
-    result = bigint_mod(result, m);
-    bigint_delete(tmp1);
+bigint_mapping_registry bigint_mappings = {NULL, 0, 0, 0, 0};
+#ifdef BIGINT_THREADS
+pthread_mutex_t bigint_mappings_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
-    bigint_delete(b_save);
-    bigint_delete(pow);
-    
-    return result;
+// The index of the first mapping that ends after an address; called with the lock held
+size_t bigint_mapping_search(const void *address) {
+    size_t low = 0, high = bigint_mappings.count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if ((const char *)address >= bigint_mappings.entries[mid].base + bigint_mappings.entries[mid].length) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
 }
 
-bigint bigint_modinv(bigint a, bigint m) {
-    bigint m0 = bigint_copy(m);
-    bigint y = bigint_from_string("0");
-    bigint x = bigint_from_string("1");
-    bigint q = bigint_from_string("0");
-    bigint t = bigint_from_string("0");
-    bigint temp = bigint_from_string("0");
-    bigint one = bigint_from_string("1");
-    a = bigint_copy(a);
-    m = bigint_copy(m);
+// The index of the mapping holding an address, or the registry's count if none does
+size_t bigint_mapping_find(const void *address) {
+    size_t i = bigint_mapping_search(address);
+    if (i < bigint_mappings.count && (const char *)address >= bigint_mappings.entries[i].base) {
+        return i;
+    }
+    return bigint_mappings.count;
+}
 
-    bigint tmp1, tmp2;
-    while (!bigint_eqzero(a)) {
-        tmp1 = q;
-        q = bigint_div(m, a);
-        bigint_delete(tmp1);
+// Publish a new count and the bounds of the mapped range; called with the lock held
+void bigint_mappings_publish(size_t count) {
+    if (count > 0) {
+        const bigint_mapping *last = &bigint_mappings.entries[count - 1];
+        BIGINT_ATOMIC_STORE(&bigint_mappings.low, (uintptr_t)bigint_mappings.entries[0].base);
+        BIGINT_ATOMIC_STORE(&bigint_mappings.high, (uintptr_t)(last->base + last->length));
+    }
+    BIGINT_ATOMIC_STORE(&bigint_mappings.count, count);
+}
 
-        tmp1 = t;
-        tmp2 = bigint_mul(q, a);
-        t = bigint_sub(m, tmp2);
-        bigint_delete(tmp1);
-        bigint_delete(tmp2);
+// Whether an address could be in a mapping, checked without the lock
+bool bigint_mapping_candidate(const void *address) {
+    uintptr_t a = (uintptr_t)address;
+    return BIGINT_ATOMIC_LOAD(&bigint_mappings.count) > 0 && a >= BIGINT_ATOMIC_LOAD(&bigint_mappings.low) &&
+           a < BIGINT_ATOMIC_LOAD(&bigint_mappings.high);
+}
 
-        tmp1 = m, tmp2 = a;
-        m = bigint_copy(a);
-        a = bigint_copy(t);
-        bigint_delete(tmp1);
-        bigint_delete(tmp2);
+void bigint_mappings_lock_acquire() {
+#ifdef BIGINT_THREADS
+    pthread_mutex_lock(&bigint_mappings_lock);
+#endif
+}
 
-        tmp1 = t;
-        tmp2 = bigint_mul(q, x);
-        t = bigint_sub(y, tmp2);
-        bigint_delete(tmp1);
-        bigint_delete(tmp2);
+void bigint_mappings_lock_release() {
+#ifdef BIGINT_THREADS
+    pthread_mutex_unlock(&bigint_mappings_lock);
+#endif
+}
 
-        tmp1 = y, tmp2 = x;
-        y = bigint_copy(x);
-        x = bigint_copy(t);
-        bigint_delete(tmp1);
-        bigint_delete(tmp2);
-    }
-    if (bigint_ltzero(m)) {
-        tmp1 = m;
-        m = bigint_add(m, m0);
-        bigint_delete(tmp1);
+/* Check whether a bigint is file-backed
+* @param n The bigint
+* @return Whether its digits live in a mapped file
+*/
+bool bigint_is_mapped(bigint n) {
+    if (!bigint_mapping_candidate(n.digits)) {
+        return false;
     }
+    bigint_mappings_lock_acquire();
+    bool mapped = bigint_mapping_find(n.digits) < bigint_mappings.count;
+    bigint_mappings_lock_release();
+    return mapped;
+}
 
-    if (bigint_eq(m, one)) {
-        bigint result = bigint_mod(y, m0);
-        if (bigint_ltzero(result)) {
-            tmp1 = result;
-            result = bigint_add(result, m0);
-            bigint_delete(tmp1);
-        }
-        bigint_delete(a);
-        bigint_delete(m);
-        bigint_delete(m0);
-        bigint_delete(y);
-        bigint_delete(x);
-        bigint_delete(q);
-        bigint_delete(t);
-        bigint_delete(temp);
-        bigint_delete(one);
-        return result;
+// Unmap and forget the mapping holding an address, returning whether there was one
+bool bigint_unmap(const void *address) {
+    if (!bigint_mapping_candidate(address)) {
+        return false;
     }
-    bigint_delete(a);
-    bigint_delete(m);
-    bigint_delete(m0);
-    bigint_delete(y);
-    bigint_delete(x);
-    bigint_delete(q);
-    bigint_delete(t);
-    bigint_delete(temp);
-    bigint_delete(one);
-    return bigint_from_int(0);
+    bigint_mappings_lock_acquire();
+    size_t i = bigint_mapping_find(address);
+    bool found = i < bigint_mappings.count;
+    if (found) {
+        munmap(bigint_mappings.entries[i].base, bigint_mappings.entries[i].length);
+        memmove(&bigint_mappings.entries[i], &bigint_mappings.entries[i + 1],
+                (bigint_mappings.count - i - 1) * sizeof(bigint_mapping));
+        bigint_mappings_publish(bigint_mappings.count - 1);
+    }
+    bigint_mappings_lock_release();
+    return found;
 }
 
-bigint bigint_sqrt(bigint n) {
-    bigint one = bigint_from_string("1");
-    bigint two = bigint_from_string("2");
-    bigint low = bigint_from_string("0");
-    bigint high = bigint_copy(n);
-    bigint mid = bigint_from_string("0");
-    while (bigint_lt(low, high)) {
-        bigint tmp1 = bigint_add(low, high);
-        bigint tmp2 = mid;
-        mid = bigint_div(tmp1, two);
-        bigint_delete(tmp1);
-        bigint_delete(tmp2);
-        tmp1 = bigint_mul(mid, mid);
-        if (bigint_lt(tmp1, n)) {
-            tmp2 = low;
-            low = bigint_add(mid, one);
-            bigint_delete(tmp2);
-        } else {
-            tmp2 = high;
-            high = bigint_copy(mid);
-            bigint_delete(tmp2);
-        }
-        bigint_delete(tmp1);
+// Map a whole file of digits read-only as a bigint and register it, skipping leading zeros
+bool bigint_map_fd(int fd, size_t length, bigint *out) {
+    if (length < 2 * sizeof(int64_t) || length % sizeof(int64_t) != 0) {
+        return false;
     }
+    // Writing through a read-only mapping faults, instead of changing the file behind the caller's back
+    char *base = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    madvise(base, length, MADV_SEQUENTIAL);
 
-    bigint_delete(one);
-    bigint_delete(two);
-    bigint_delete(mid);
-    bigint_delete(high);
+    bigint_mappings_lock_acquire();
+    if (bigint_mappings.count == bigint_mappings.capacity) {
+        bigint_mappings.capacity = bigint_mappings.capacity ? bigint_mappings.capacity * 2 : 8;
+        bigint_mappings.entries = realloc(bigint_mappings.entries, bigint_mappings.capacity * sizeof(bigint_mapping));
+    }
+    size_t i = bigint_mapping_search(base);
+    memmove(&bigint_mappings.entries[i + 1], &bigint_mappings.entries[i], (bigint_mappings.count - i) * sizeof(bigint_mapping));
+    bigint_mapping mapping = {base, length};
+    bigint_mappings.entries[i] = mapping;
+    bigint_mappings_publish(bigint_mappings.count + 1);
+    bigint_mappings_lock_release();
 
-    return low;
+    int64_t *words = (int64_t *)base;
+    out->is_negative = words[0] != 0;
+    out->digits = words + 1;
+    out->size = length / sizeof(int64_t) - 1;
+    while (out->size > 1 && out->digits[0] == 0) {
+        out->digits++;
+        out->size--;
+    }
+    if (out->size == 1 && out->digits[0] == 0) {
+        out->is_negative = false;
+    }
+    return true;
 }
 
-bool bigint_is_even(bigint n) {
-    return n.digits[n.size - 1] % 2 == 0;
+// Open a file for mapped digits, or an anonymous temporary file when path is NULL
+int bigint_map_create(const char *path, size_t length) {
+    int fd;
+    if (path) {
+        fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    } else {
+        FILE *file = tmpfile();
+        fd = file ? dup(fileno(file)) : -1;
+        if (file) {
+            fclose(file);
+        }
+    }
+    if (fd >= 0 && ftruncate(fd, (off_t)length) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
 }
 
-bool bigint_is_odd(bigint n) {
-    return n.digits[n.size - 1] % 2 == 1;
+// pwrite or pread a whole range, retrying short and interrupted transfers
+bool bigint_fd_transfer(int fd, void *buffer, size_t size, size_t offset, bool writing) {
+    char *bytes = buffer;
+    while (size > 0) {
+        ssize_t result = writing ? pwrite(fd, bytes, size, (off_t)offset) : pread(fd, bytes, size, (off_t)offset);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        bytes += result;
+        offset += (size_t)result;
+        size -= (size_t)result;
+    }
+    return true;
 }
 
-bool bigint_is_prime(bigint n) {
-    bigint tmp1, tmp2;
-    // Check if the number is even
-    if (bigint_is_even(n)) {
+/* Copy a bigint into a memory-mapped file
+* @param path The file to create, or NULL for an anonymous temporary file
+* @param n The bigint to copy
+* @param out Set to the file-backed copy, to be freed with bigint_delete
+* @return Whether the file was written and mapped
+*/
+bool bigint_map(const char *path, bigint n, bigint *out) {
+    size_t length = (n.size + 1) * sizeof(int64_t);
+    int fd = bigint_map_create(path, length);
+    if (fd < 0) {
         return false;
     }
+    int64_t sign = n.is_negative;
+    bool ok = bigint_fd_transfer(fd, &sign, sizeof(sign), 0, true) &&
+              bigint_fd_transfer(fd, n.digits, n.size * sizeof(int64_t), sizeof(int64_t), true) &&
+              bigint_map_fd(fd, length, out);
+    close(fd);
+    return ok;
+}
 
-    // If the last digit is a 5 or 0, the number is divisible by 5
-    if (n.size > 1 && (n.digits[n.size - 1] == 5 || n.digits[n.size - 1] == 0)) {
+/* Map a file written by bigint_map or bigint_mul_ooc
+* The file is opened and mapped read-only, so it only needs read
+* permission, and modifying the result in place faults.
+* @param path The file to map
+* @param out Set to the file-backed bigint, to be freed with bigint_delete
+* @return Whether the file was mapped
+*/
+bool bigint_map_open(const char *path, bigint *out) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
         return false;
     }
-    // Check if the sum of the digits is divisible by 3
-    bigint sum = bigint_from_string("0");
-    for (size_t i = 0; i < n.size; i++) {
-        tmp1 = bigint_from_int(n.digits[i]);
-        tmp2 = sum;
-        sum = bigint_add(sum, tmp1);
-        bigint_delete(tmp1);
-        bigint_delete(tmp2);
+    off_t length = lseek(fd, 0, SEEK_END);
+    bool ok = length > 0 && bigint_map_fd(fd, (size_t)length, out);
+    close(fd);
+    return ok;
+}
+
+// The largest number of limbs per row of an out-of-core product
+#ifndef BIGINT_OOC_BLOCK
+#define BIGINT_OOC_BLOCK ((size_t)1 << 20)
+#endif
+
+// The memory an out-of-core product may use in bytes, or 0 for an eighth of physical memory
+#ifndef BIGINT_OOC_MEMORY
+#define BIGINT_OOC_MEMORY 0
+#endif
+
+// Above this many 4-digit limbs in the smaller factor, coefficients could exceed the product of the NTT primes
+#ifndef BIGINT_OOC_WIDE_LIMBS
+#define BIGINT_OOC_WIDE_LIMBS ((uint64_t)BIGINT_NTT_PRIME1 * BIGINT_NTT_PRIME2 / ((uint64_t)(BIGINT_LIMB_BASE - 1) * (BIGINT_LIMB_BASE - 1)))
+#endif
+
+// The memory budget of an out-of-core product in bytes
+size_t bigint_ooc_memory(void) {
+    size_t budget = BIGINT_OOC_MEMORY;
+    if (budget == 0) {
+        long pages = sysconf(_SC_PHYS_PAGES), page = sysconf(_SC_PAGESIZE);
+        budget = pages > 0 && page > 0 ? (size_t)pages / 8 * (size_t)page : (size_t)1 << 28;
     }
+    return budget;
+}
 
-    tmp1 = bigint_from_string("3");
-    tmp2 = bigint_mod(sum, tmp1);
-    if (bigint_eqzero(tmp2)) {
-        bigint_delete(tmp1);
-        bigint_delete(tmp2);
-        bigint_delete(sum);
-        return false;
+// The limb of width decimal digits at position index of a bigint, least significant first
+int64_t bigint_limb_at(bigint n, size_t index, size_t width) {
+    int64_t limb = 0;
+    for (size_t j = width; j > 0; j--) {
+        size_t pos = index * width + j - 1;
+        limb = limb * 10 + (pos < n.size ? n.digits[n.size - pos - 1] : 0);
     }
-    bigint_delete(tmp1);
-    bigint_delete(tmp2);
-    bigint_delete(sum);
+    return limb;
+}
 
-    bigint sqrt_n = bigint_sqrt(n);
-    
-    for (tmp1 = bigint_from_string("2"); bigint_le(tmp1, sqrt_n); bigint_inc(&tmp1)) {
-        tmp2 = bigint_mod(n, tmp1);
-        if (bigint_eqzero(tmp2)) {
-            bigint_delete(tmp1);
-            bigint_delete(tmp2);
-            bigint_delete(sqrt_n);
+// Transform each row of a bigint's limbs modulo both primes and write the spectra to a file
+bool bigint_ooc_spectra(bigint n, size_t width, size_t block, size_t rows, int fd, size_t offset, uint32_t *buffer) {
+    const uint32_t primes[2] = {BIGINT_NTT_PRIME1, BIGINT_NTT_PRIME2};
+    size_t length = 2 * block;
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t k = 0; k < 2; k++) {
+            memset(buffer, 0, length * sizeof(uint32_t));
+            for (size_t j = 0; j < block; j++) {
+                buffer[j] = (uint32_t)bigint_limb_at(n, i * block + j, width);
+            }
+            bigint_ntt(buffer, length, primes[k], false);
+            if (!bigint_fd_transfer(fd, buffer, length * sizeof(uint32_t), offset, true)) {
+                return false;
+            }
+            offset += length * sizeof(uint32_t);
+        }
+    }
+    return true;
+}
+
+// Read columns [first, first + panel) of rows spectra at offset, one column per height entries of columns
+bool bigint_ooc_read_panel(int fd, size_t offset, size_t rows, size_t stride, size_t first, size_t panel,
+                           size_t height, uint32_t *segment, uint32_t *columns) {
+    memset(columns, 0, panel * height * sizeof(uint32_t));
+    for (size_t r = 0; r < rows; r++) {
+        if (!bigint_fd_transfer(fd, segment, panel * sizeof(uint32_t), offset + r * stride + first * sizeof(uint32_t), false)) {
             return false;
         }
-        bigint_delete(tmp2);
+        for (size_t c = 0; c < panel; c++) {
+            columns[c * height + r] = segment[c];
+        }
     }
-    bigint_delete(tmp1);
-    bigint_delete(sqrt_n);
     return true;
 }
 
+/* Multiply two bigints out of core into a file-backed product
+* The limbs of each factor form a matrix with one row per block. The
+* product is a two-dimensional convolution: NTTs along the rows, then
+* along the columns, a pointwise product, and the inverse transforms in
+* the opposite order. Each step is one pass over a temporary file. Row
+* passes read and write whole rows in order, and column passes move
+* panels of as many columns as fit in BIGINT_OOC_MEMORY, with one
+* contiguous transfer per row and panel. The file traffic is a fixed
+* number of passes over the spectra, about 64 bytes per limb of the
+* product, instead of growing with the square of the number of blocks.
+* Factors with more than BIGINT_OOC_WIDE_LIMBS limbs are split into
+* 2-digit limbs, so every coefficient stays below the product of the
+* two primes.
+* @param a The first factor, in memory or file-backed
+* @param b The second factor, in memory or file-backed
+* @param path The file for the product, or NULL for an anonymous temporary file
+* @param block The number of limbs per row, a power of two, or 0 to choose
+* about the square root of the product's length within the memory budget
+* @param product Set to the file-backed product, to be freed with bigint_delete
+* @return Whether every file operation succeeded and the transforms were long enough
+*/
+bool bigint_mul_ooc(bigint a, bigint b, const char *path, size_t block, bigint *product) {
+    a = bigint_trimmed(a);
+    b = bigint_trimmed(b);
+    size_t width = BIGINT_LIMB_DIGITS, smaller = a.size < b.size ? a.size : b.size;
+    if ((smaller + width - 1) / width > BIGINT_OOC_WIDE_LIMBS) {
+        width = 2;
+    }
+    uint64_t base = width == 2 ? 100 : BIGINT_LIMB_BASE;
+    size_t an = (a.size + width - 1) / width, bn = (b.size + width - 1) / width;
+    size_t limbs = an + bn, digits = limbs * width;
+    size_t budget = bigint_ooc_memory();
+    if (block == 0) {
+        // A row pass holds about 64 bytes per limb of a row
+        for (block = 1; block < BIGINT_OOC_BLOCK && block * block < limbs && 128 * block <= budget; block <<= 1) {
+        }
+    }
+    assert((block & (block - 1)) == 0 && 2 * block <= BIGINT_NTT_MAX_LENGTH);
+    size_t na = (an + block - 1) / block, nb = (bn + block - 1) / block, rows = na + nb - 1;
+    size_t height = 1;
+    while (height < rows) {
+        height <<= 1;
+    }
+    if (height > BIGINT_NTT_MAX_LENGTH) {
+        return false;
+    }
+    size_t length = 2 * block, spectrum = length * sizeof(uint32_t);
+    size_t panel = 1;
+    while (panel < length && 4 * panel * height * sizeof(uint32_t) <= budget) {
+        panel <<= 1;
+    }
+
+    // The temporary file holds the row spectra of a, of b and of the product, both primes per row
+    size_t a_offset = 0, b_offset = 2 * na * spectrum, p_offset = 2 * (na + nb) * spectrum;
+    int spectra = bigint_map_create(NULL, 0);
+    int fd = bigint_map_create(path, (digits + 1) * sizeof(int64_t));
+    uint32_t *buffer = malloc(2 * spectrum);
+    uint32_t *segment = malloc(panel * sizeof(uint32_t));
+    uint32_t *columns = malloc(2 * panel * height * sizeof(uint32_t));
+    uint64_t *window = calloc(length, sizeof(uint64_t));
+    int64_t *out = malloc(block * width * sizeof(int64_t));
+    int64_t sign = a.is_negative != b.is_negative;
+    bool ok = spectra >= 0 && fd >= 0 && buffer && segment && columns && window && out &&
+              bigint_ooc_spectra(a, width, block, na, spectra, a_offset, buffer) &&
+              bigint_ooc_spectra(b, width, block, nb, spectra, b_offset, buffer) &&
+              bigint_fd_transfer(fd, &sign, sizeof(sign), 0, true);
+
+    // Column passes: convolve each column of a's spectra with the same column of b's
+    const uint32_t primes[2] = {BIGINT_NTT_PRIME1, BIGINT_NTT_PRIME2};
+    uint32_t *x = columns, *y = columns + panel * height;
+    for (size_t m = 0; ok && m < 2; m++) {
+        uint32_t p = primes[m];
+        size_t shift = m * spectrum;
+        for (size_t first = 0; ok && first < length; first += panel) {
+            ok = bigint_ooc_read_panel(spectra, a_offset + shift, na, 2 * spectrum, first, panel, height, segment, x) &&
+                 bigint_ooc_read_panel(spectra, b_offset + shift, nb, 2 * spectrum, first, panel, height, segment, y);
+            for (size_t c = 0; ok && c < panel; c++) {
+                uint32_t *xc = x + c * height, *yc = y + c * height;
+                bigint_ntt(xc, height, p, false);
+                bigint_ntt(yc, height, p, false);
+                for (size_t r = 0; r < height; r++) {
+                    xc[r] = (uint32_t)((uint64_t)xc[r] * yc[r] % p);
+                }
+                bigint_ntt(xc, height, p, true);
+            }
+            for (size_t r = 0; ok && r < rows; r++) {
+                for (size_t c = 0; c < panel; c++) {
+                    segment[c] = x[c * height + r];
+                }
+                ok = bigint_fd_transfer(spectra, segment, panel * sizeof(uint32_t),
+                                        p_offset + r * 2 * spectrum + shift + first * sizeof(uint32_t), true);
+            }
+        }
+    }
+
+    // Row pass: invert each row of the product, recombine the primes and carry into digits
+    uint64_t p1_inverse = bigint_powmod_ui(BIGINT_NTT_PRIME1, BIGINT_NTT_PRIME2 - 2, BIGINT_NTT_PRIME2);
+    uint64_t carry = 0;
+    for (size_t k = 0; ok && k <= rows; k++) {
+        if (k < rows) {
+            ok = bigint_fd_transfer(spectra, buffer, 2 * spectrum, p_offset + k * 2 * spectrum, false);
+            bigint_ntt(buffer, length, BIGINT_NTT_PRIME1, true);
+            bigint_ntt(buffer + length, length, BIGINT_NTT_PRIME2, true);
+            for (size_t t = 0; t < length; t++) {
+                uint64_t c1 = buffer[t], c2 = buffer[length + t];
+                uint64_t diff = (c2 + BIGINT_NTT_PRIME2 - c1 % BIGINT_NTT_PRIME2) % BIGINT_NTT_PRIME2;
+                window[t] += c1 + (uint64_t)BIGINT_NTT_PRIME1 * (diff * p1_inverse % BIGINT_NTT_PRIME2);
+            }
+        }
+
+        // The low half of the window is final: carry it into digits, most significant first
+        size_t start = k * block, count = start >= limbs ? 0 : start + block <= limbs ? block : limbs - start;
+        for (size_t t = 0; t < count; t++) {
+            uint64_t v = window[t] + carry;
+            int64_t limb = (int64_t)(v % base);
+            carry = v / base;
+            for (size_t d = 0; d < width; d++) {
+                out[(count - t) * width - d - 1] = limb % 10;
+                limb /= 10;
+            }
+        }
+        memmove(window, window + block, block * sizeof(uint64_t));
+        memset(window + block, 0, block * sizeof(uint64_t));
+        size_t offset = (1 + digits - (start + count) * width) * sizeof(int64_t);
+        ok = ok && bigint_fd_transfer(fd, out, count * width * sizeof(int64_t), offset, true);
+    }
+    assert(!ok || carry == 0);
+
+    free(buffer);
+    free(segment);
+    free(columns);
+    free(window);
+    free(out);
+    if (spectra >= 0) {
+        close(spectra);
+    }
+    ok = ok && bigint_map_fd(fd, (digits + 1) * sizeof(int64_t), product);
+    if (fd >= 0) {
+        close(fd);
+    }
+    return ok;
+}
+#endif
+
 /* Delete a bigint
 * @param n The bigint to delete
 */
 #include <execinfo.h>
 void bigint_delete(bigint n) {
+#ifdef BIGINT_POSIX
+    if (bigint_unmap(n.digits)) {
+        return;
+    }
+#endif
     free(n.digits);
     n.digits = NULL;
     n.is_negative = false;
@@ -0,0 +1,116 @@
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+
+uint64_t seed = 4242;
+
+// Create a random bigint with the given number of digits
+bigint random_bigint(size_t size) {
+    char *digits = malloc(size + 1);
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        digits[i] = '0' + (seed >> 33) % 10;
+    }
+    if (digits[0] == '0') {
+        digits[0] = '1';
+    }
+    digits[size] = '\0';
+    bigint result = bigint_from_string(digits);
+    free(digits);
+    return result;
+}
+
+int main() {
+    // Small and large quotients, including divisors with factors of 2 and 5
+    size_t sizes[][2] = {{1, 1}, {5, 3}, {30, 12}, {80, 40}, {500, 20}, {900, 300}, {50, 700}};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (uint64_t scale = 1; scale <= 1000; scale *= 20) {
+            bigint q = random_bigint(sizes[i][0]);
+            bigint d = random_bigint(sizes[i][1]);
+            bigint_mul_ui_inplace(&d, scale);
+            d.is_negative = scale % 3 == 2;
+            bigint a = bigint_mul(q, d);
+
+            bigint r = bigint_divexact(a, d);
+            assert(bigint_eq(r, q));
+            assert(bigint_divisible_p(a, d));
+
+            // One more than a multiple is not divisible
+            if (bigint_cmp_si(d, 1) != 0 && bigint_cmp_si(d, -1) != 0) {
+                bigint_inc(&a);
+                assert(!bigint_divisible_p(a, d));
+            }
+
+            bigint_delete(q);
+            bigint_delete(d);
+            bigint_delete(a);
+            bigint_delete(r);
+        }
+    }
+
+    // Divisibility that only depends on factors of 2 and 5
+    bigint a = bigint_from_int(1024000);
+    bigint d = bigint_from_int(16384);
+    assert(!bigint_divisible_p(a, d));
+    bigint_delete(d);
+    d = bigint_from_int(8000);
+    assert(bigint_divisible_p(a, d));
+    bigint r = bigint_divexact(a, d);
+    assert(bigint_cmp_si(r, 128) == 0);
+    bigint_delete(r);
+    bigint_delete(d);
+
+    // Zero is divisible by everything but only zero is divisible by zero
+    d = bigint_zero();
+    assert(!bigint_divisible_p(a, d));
+    assert(bigint_divisible_p(d, a));
+    bigint_delete(d);
+    bigint_delete(a);
+
+    // A smaller number is never divisible by a larger one
+    a = bigint_from_int(21);
+    d = bigint_from_int(63);
+    assert(!bigint_divisible_p(a, d));
+    bigint_delete(a);
+    bigint_delete(d);
+
+    // Factorial quotients, whose divisors have thousands of factors of 2 and 5
+    a = bigint_fac_ui(12000);
+    d = bigint_fac_ui(5000);
+    clock_t start = clock();
+    r = bigint_divexact(a, d);
+    assert(bigint_divisible_p(a, d));
+    // Removing the factors one digit pass at a time took seconds here
+    assert(clock() - start < 2 * CLOCKS_PER_SEC);
+    bigint q = bigint_div(a, d);
+    assert(bigint_eq(r, q));
+    bigint_delete(q);
+    bigint_inc(&a);
+    assert(!bigint_divisible_p(a, d));
+    bigint_delete(a);
+    bigint_delete(r);
+
+    // A divisor that is a large power of 5 times a factorial
+    bigint five = bigint_pow_ui(5, 900);
+    bigint_mul_ui_inplace(&five, 7);
+    bigint divisor = bigint_mul(five, d);
+    q = random_bigint(400);
+    a = bigint_mul(q, divisor);
+    r = bigint_divexact(a, divisor);
+    assert(bigint_eq(r, q));
+    assert(bigint_divisible_p(a, divisor));
+    bigint_delete(r);
+    bigint_delete(a);
+    a = bigint_mul(q, d);
+    assert(!bigint_divisible_p(a, divisor));
+    bigint_delete(a);
+    bigint_delete(q);
+    bigint_delete(five);
+    bigint_delete(divisor);
+    bigint_delete(d);
+
+    printf("Test passed\n");
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+
+// Check that the next prime after a decimal string is another decimal string
+void check_nextprime(const char *n, const char *expected) {
+    bigint a = bigint_from_string(n);
+    bigint b = bigint_from_string(expected);
+    bigint p = bigint_nextprime(a);
+    assert(bigint_eq(p, b));
+    bigint_delete(a);
+    bigint_delete(b);
+    bigint_delete(p);
+}
+
+int main() {
+    // Test Miller-Rabin against trial division
+    for (int64_t i = -5; i < 3000; i++) {
+        bigint n = bigint_from_int(i);
+        bool prime = i >= 2;
+        for (int64_t d = 2; d * d <= i; d++) {
+            if (i % d == 0) {
+                prime = false;
+            }
+        }
+        assert(bigint_probab_prime_p(n, 25) == prime);
+        bigint_delete(n);
+    }
+
+    // Carmichael numbers and a strong pseudoprime to base 2 are composite
+    const char *composites[] = {"561", "41041", "3215031751", "2047", "318665857834031151167461"};
+    for (size_t i = 0; i < sizeof(composites) / sizeof(composites[0]); i++) {
+        bigint n = bigint_from_string(composites[i]);
+        assert(!bigint_probab_prime_p(n, 25));
+        bigint_delete(n);
+    }
+
+    // Mersenne primes, with extra random rounds
+    bigint n = bigint_from_string("170141183460469231731687303715884105727");
+    assert(bigint_probab_prime_p(n, 30));
+    bigint_delete(n);
+    n = bigint_from_string("170141183460469231731687303715884105729");
+    assert(!bigint_probab_prime_p(n, 30));
+    bigint_delete(n);
+
+    // Test next prime, including the sieving primes themselves
+    check_nextprime("-10", "2");
+    check_nextprime("1", "2");
+    check_nextprime("2", "3");
+    check_nextprime("7", "11");
+    check_nextprime("65520", "65521");
+    check_nextprime("65521", "65537");
+    check_nextprime("100000000000000000000", "100000000000000000039");
+    check_nextprime("18446744073709551616", "18446744073709551629");
+
+    // Test random primes of an exact size
+    uint64_t state = 1;
+    for (size_t bits = 2; bits <= 256; bits *= 2) {
+        bigint p = bigint_random_prime(bits, &state);
+        assert(bigint_bit_length(p) == bits);
+        assert(bigint_probab_prime_p(p, 30));
+        bigint_delete(p);
+    }
+
+    printf("Test passed\n");
+
+    return 0;
+}
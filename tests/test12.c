@@ -0,0 +1,117 @@
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+
+// Check that a factorization multiplies back to n and has only probable primes
+void check_factors(bigint n, bigint_factors factors) {
+    bigint product = bigint_from_int(1);
+    for (size_t i = 0; i < factors.count; i++) {
+        assert(bigint_probab_prime_p(factors.primes[i], 25));
+        assert(i == 0 || bigint_lt(factors.primes[i - 1], factors.primes[i]));
+        for (size_t j = 0; j < factors.exponents[i]; j++) {
+            bigint tmp = bigint_mul(product, factors.primes[i]);
+            bigint_delete(product);
+            product = tmp;
+        }
+    }
+    bigint abs = bigint_abs(n);
+    assert(bigint_eq(product, abs));
+    bigint_delete(product);
+}
+
+// Check that a method found a proper factor of n
+void check_splits(bigint n, bigint factor) {
+    assert(bigint_cmp_si(factor, 1) > 0 && bigint_lt(factor, n));
+    assert(bigint_divisible_p(n, factor));
+    bigint_delete(factor);
+}
+
+// Check that a method found exactly the expected factor
+void check_found(bigint factor, const char *expected) {
+    bigint e = bigint_from_string(expected);
+    assert(bigint_eq(factor, e));
+    bigint_delete(e);
+    bigint_delete(factor);
+}
+
+int main() {
+    // Test gcd
+    bigint a = bigint_from_string("-123456789012345678901234567890");
+    bigint b = bigint_from_string("987654321098765432109876543210");
+    bigint g = bigint_gcd(a, b);
+    bigint expected = bigint_from_string("9000000000900000000090");
+    assert(bigint_eq(g, expected));
+    assert(!g.is_negative);
+    bigint_delete(g);
+    bigint_delete(expected);
+    bigint zero = bigint_zero();
+    g = bigint_gcd(zero, b);
+    assert(bigint_eq(g, b));
+    bigint_delete(g);
+    bigint_delete(zero);
+    bigint_delete(a);
+    bigint_delete(b);
+
+    // Factor every small integer
+    for (int64_t i = -20; i < 3000; i++) {
+        bigint n = bigint_from_int(i);
+        bigint_factors factors = bigint_factor(n);
+        if (i == 0) {
+            assert(factors.count == 0);
+        } else {
+            check_factors(n, factors);
+        }
+        bigint_factors_delete(factors);
+        bigint_delete(n);
+    }
+
+    // 2^64 + 1 = 274177 * 67280421310721
+    bigint n = bigint_from_string("18446744073709551617");
+    bigint_factors factors = bigint_factor(n);
+    assert(factors.count == 2);
+    check_factors(n, factors);
+    check_found(bigint_copy(factors.primes[0]), "274177");
+    check_found(bigint_copy(factors.primes[1]), "67280421310721");
+    bigint_factors_delete(factors);
+    bigint_delete(n);
+
+    // Repeated and small factors: 2^5 * 3^2 * 10007^2 * 1000003^2
+    n = bigint_from_string("28840507154264235007008");
+    factors = bigint_factor(n);
+    check_factors(n, factors);
+    assert(factors.count == 4);
+    assert(factors.exponents[0] == 5 && factors.exponents[1] == 2);
+    assert(factors.exponents[2] == 2 && factors.exponents[3] == 2);
+    bigint_factors_delete(factors);
+    bigint_delete(n);
+
+    // Rho on a product of two 12-digit primes
+    n = bigint_from_string("30000000008600000000231");
+    check_splits(n, bigint_factor_rho(n, 10000000, 1));
+    bigint_delete(n);
+
+    // p - 1 = 8 * 12751838590207 * 50021 is smooth apart from one stage 2 prime
+    n = bigint_from_string("3572014421476428590664993263693627");
+    bigint f = bigint_factor_pm1(n, 1000, 1000);
+    assert(bigint_eqzero(f));
+    bigint_delete(f);
+    check_found(bigint_factor_pm1(n, 1000, 100000), "5102877744965954777");
+    bigint_delete(n);
+
+    // ECM on a product of 12 and 15-digit primes
+    n = bigint_from_string("70000000002105100000000153");
+    check_splits(n, bigint_factor_ecm(n, 2000, 100000, 200, 1));
+    bigint_delete(n);
+
+    // The full pipeline on a negative 25-digit semiprime
+    n = bigint_from_string("-1400000007700102000000561");
+    factors = bigint_factor(n);
+    assert(factors.count == 2);
+    check_factors(n, factors);
+    bigint_factors_delete(factors);
+    bigint_delete(n);
+
+    printf("Test passed\n");
+
+    return 0;
+}
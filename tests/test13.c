@@ -0,0 +1,238 @@
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+
+uint64_t seed = 2024;
+
+// 2^127 - 1 and a small negative value, as static constants
+BIGINT_CONSTANT(mersenne_127, false,
+    1, 7, 0, 1, 4, 1, 1, 8, 3, 4, 6, 0, 4, 6, 9, 2, 3, 1, 7, 3,
+    1, 6, 8, 7, 3, 0, 3, 7, 1, 5, 8, 8, 4, 1, 0, 5, 7, 2, 7);
+BIGINT_CONSTANT(minus_forty_two, true, 4, 2);
+
+// Create a random bigint with the given number of digits
+bigint random_bigint(size_t size) {
+    char *digits = malloc(size + 1);
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        digits[i] = '0' + (seed >> 33) % 10;
+    }
+    if (digits[0] == '0') {
+        digits[0] = '1';
+    }
+    digits[size] = '\0';
+    bigint result = bigint_from_string(digits);
+    free(digits);
+    return result;
+}
+
+// The product of bases[i]^exponents[i] mod m, one power at a time
+bigint naive_multi_pow(bigint *bases, bigint *exponents, size_t count, bigint m) {
+    bigint result = bigint_from_int(1);
+    for (size_t i = 0; i < count; i++) {
+        bigint power = bigint_fast_pow(bases[i], exponents[i], m);
+        bigint product = bigint_mul(result, power);
+        bigint_delete(result);
+        result = bigint_mod(product, m);
+        bigint_delete(product);
+        bigint_delete(power);
+    }
+    return result;
+}
+
+// Check bigint_multi_pow against naive_multi_pow on random inputs
+void check_multi_pow(bigint_modctx ctx, bigint m, size_t count, size_t digits) {
+    bigint *bases = malloc(count * sizeof(bigint));
+    bigint *exponents = malloc(count * sizeof(bigint));
+    for (size_t i = 0; i < count; i++) {
+        bases[i] = random_bigint(digits);
+        exponents[i] = random_bigint(1 + (i * 7) % digits);
+    }
+    bigint a = bigint_multi_pow(ctx, bases, exponents, count);
+    bigint b = naive_multi_pow(bases, exponents, count, m);
+    assert(bigint_eq(a, b));
+    bigint_delete(a);
+    bigint_delete(b);
+    for (size_t i = 0; i < count; i++) {
+        bigint_delete(bases[i]);
+        bigint_delete(exponents[i]);
+    }
+    free(bases);
+    free(exponents);
+}
+
+typedef struct {
+    bigint_powtable table;
+    bigint m;
+    bigint g;
+    size_t offset;
+    size_t failures;
+} pow_task;
+
+// Compare table exponentiations against bigint_fast_pow on a shared table
+void *pow_worker(void *arg) {
+    pow_task *task = arg;
+    for (size_t i = 0; i < 8; i++) {
+        bigint e = bigint_from_int((int64_t)(task->offset * 1000003 + i * 7919));
+        bigint a = bigint_powtable_pow(task->table, e);
+        bigint b = bigint_fast_pow(task->g, e, task->m);
+        if (!bigint_eq(a, b)) {
+            task->failures++;
+        }
+        bigint_delete(a);
+        bigint_delete(b);
+        bigint_delete(e);
+    }
+    return NULL;
+}
+
+int main() {
+    // g = 3 modulo the Mersenne prime 2^127 - 1, for exponents up to 256 bits
+    bigint m = bigint_from_string("170141183460469231731687303715884105727");
+    bigint g = bigint_from_int(3);
+    bigint_powtable table = bigint_powtable_new(g, m, 256, 6);
+    for (size_t i = 0; i < 30; i++) {
+        // 77 digits is just under 2^256
+        bigint e = random_bigint(1 + i * 2 + (i == 29 ? 18 : 0));
+        bigint a = bigint_powtable_pow(table, e);
+        bigint b = bigint_fast_pow(g, e, m);
+        assert(bigint_eq(a, b));
+        bigint_delete(a);
+        bigint_delete(b);
+        bigint_delete(e);
+    }
+
+    // Zero, one and oversized exponents
+    bigint e = bigint_zero();
+    bigint a = bigint_powtable_pow(table, e);
+    assert(bigint_cmp_si(a, 1) == 0);
+    bigint_delete(a);
+    bigint_delete(e);
+    e = bigint_from_int(1);
+    a = bigint_powtable_pow(table, e);
+    assert(bigint_cmp_si(a, 3) == 0);
+    bigint_delete(a);
+    bigint_delete(e);
+    e = random_bigint(120);
+    a = bigint_powtable_pow(table, e);
+    bigint b = bigint_fast_pow(g, e, m);
+    assert(bigint_eq(a, b));
+    bigint_delete(a);
+    bigint_delete(b);
+    bigint_delete(e);
+
+    // Save and load the table
+    FILE *file = tmpfile();
+    assert(bigint_powtable_write(table, file));
+    rewind(file);
+    bigint_powtable loaded;
+    assert(bigint_powtable_read(file, &loaded));
+    fclose(file);
+    assert(loaded.rows == table.rows && loaded.columns == table.columns);
+    for (size_t i = 0; i < ((size_t)1 << table.rows); i++) {
+        assert(bigint_eq(loaded.table[i], table.table[i]));
+    }
+    e = random_bigint(70);
+    a = bigint_powtable_pow(loaded, e);
+    b = bigint_fast_pow(g, e, m);
+    assert(bigint_eq(a, b));
+    bigint_delete(a);
+    bigint_delete(b);
+    bigint_delete(e);
+    bigint_powtable_delete(loaded);
+
+    // Truncated and malformed files are rejected
+    file = tmpfile();
+    fprintf(file, "bigint_powtable 2 4\n97\n3\n1\n3\n");
+    rewind(file);
+    assert(!bigint_powtable_read(file, &loaded));
+    fclose(file);
+    file = tmpfile();
+    fprintf(file, "bigint_powtable 1 4\n97\n3\n1\n100\n");
+    rewind(file);
+    assert(!bigint_powtable_read(file, &loaded));
+    fclose(file);
+
+    // A modulus that is not positive, or a base or entry outside [0, m), fails instead of aborting
+    const char *invalid[] = {
+        "bigint_powtable 1 4\n-97\n3\n1\n3\n",
+        "bigint_powtable 1 4\n97\n97\n1\n3\n",
+        "bigint_powtable 1 4\n97\n-3\n1\n3\n",
+        "bigint_powtable 1 4\n97\n3\n1\n-3\n",
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        file = tmpfile();
+        fputs(invalid[i], file);
+        rewind(file);
+        assert(!bigint_powtable_read(file, &loaded));
+        fclose(file);
+    }
+
+    // Share one table between threads
+    pthread_t threads[4];
+    pow_task tasks[4];
+    for (size_t t = 0; t < 4; t++) {
+        pow_task task = {table, m, g, t, 0};
+        tasks[t] = task;
+        assert(pthread_create(&threads[t], NULL, pow_worker, &tasks[t]) == 0);
+    }
+    for (size_t t = 0; t < 4; t++) {
+        pthread_join(threads[t], NULL);
+        assert(tasks[t].failures == 0);
+    }
+
+    // Multi-exponentiation with Straus' method and with buckets
+    bigint_modctx ctx = bigint_modctx_new(m);
+    check_multi_pow(ctx, m, 1, 40);
+    check_multi_pow(ctx, m, 2, 77);
+    check_multi_pow(ctx, m, 5, 30);
+    check_multi_pow(ctx, m, BIGINT_PIPPENGER_THRESHOLD + 8, 40);
+
+    // Zero exponents give the empty product, and a zero base gives zero
+    bigint bases[3] = {bigint_from_int(5), bigint_from_int(7), bigint_copy(m)};
+    bigint exponents[3] = {bigint_zero(), bigint_zero(), bigint_zero()};
+    a = bigint_multi_pow(ctx, bases, exponents, 2);
+    assert(bigint_cmp_si(a, 1) == 0);
+    bigint_delete(a);
+    bigint_delete(exponents[2]);
+    exponents[2] = bigint_from_int(3);
+    a = bigint_multi_pow(ctx, bases, exponents, 3);
+    assert(bigint_eqzero(a));
+    bigint_delete(a);
+    for (size_t i = 0; i < 3; i++) {
+        bigint_delete(bases[i]);
+        bigint_delete(exponents[i]);
+    }
+    bigint_modctx_delete(ctx);
+
+    // Static constants are ordinary read-only operands, also on other threads
+    assert(bigint_eq(mersenne_127, m));
+    assert(bigint_cmp_si(minus_forty_two, -42) == 0);
+    a = bigint_add(mersenne_127, minus_forty_two);
+    b = bigint_sub_ui(m, 42);
+    assert(bigint_eq(a, b));
+    bigint_delete(a);
+    bigint_delete(b);
+    e = bigint_sub_ui(mersenne_127, 1);
+    a = bigint_fast_pow(g, e, mersenne_127);
+    assert(bigint_cmp_si(a, 1) == 0);
+    bigint_delete(a);
+    bigint_delete(e);
+    for (size_t t = 0; t < 4; t++) {
+        pow_task task = {table, mersenne_127, g, t + 4, 0};
+        tasks[t] = task;
+        assert(pthread_create(&threads[t], NULL, pow_worker, &tasks[t]) == 0);
+    }
+    for (size_t t = 0; t < 4; t++) {
+        pthread_join(threads[t], NULL);
+        assert(tasks[t].failures == 0);
+    }
+
+    bigint_powtable_delete(table);
+    bigint_delete(g);
+    bigint_delete(m);
+
+    printf("Test passed\n");
+
+    return 0;
+}
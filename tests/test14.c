@@ -0,0 +1,460 @@
+#define BIGINT_NTT_THRESHOLD 40
+#define BIGINT_NEWTON_DIV_THRESHOLD 40
+#define BIGINT_OOC_MEMORY 65536
+#define BIGINT_OOC_WIDE_LIMBS 500
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+uint64_t seed = 7;
+
+// Create a random bigint with the given number of digits
+bigint random_bigint(size_t size) {
+    char *digits = malloc(size + 1);
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        digits[i] = '0' + (seed >> 33) % 10;
+    }
+    if (digits[0] == '0') {
+        digits[0] = '1';
+    }
+    digits[size] = '\0';
+    bigint result = bigint_from_string(digits);
+    free(digits);
+    return result;
+}
+
+// Check an NTT product against the schoolbook method
+void check_mul(size_t a_size, size_t b_size) {
+    bigint a = random_bigint(a_size);
+    bigint b = random_bigint(b_size);
+    size_t an = bigint_limb_count(a), bn = bigint_limb_count(b);
+    int64_t *al = malloc(an * sizeof(int64_t));
+    int64_t *bl = malloc(bn * sizeof(int64_t));
+    int64_t *expected = malloc((an + bn) * sizeof(int64_t));
+    bigint_pack_limbs(a, al);
+    bigint_pack_limbs(b, bl);
+    bigint_limbs_mul_basecase(al, an, bl, bn, expected);
+    bigint c = bigint_mul(a, b);
+    bigint d = bigint_unpack_limbs(expected, an + bn, false);
+    assert(bigint_eq(c, d));
+    bigint_delete(a);
+    bigint_delete(b);
+    bigint_delete(c);
+    bigint_delete(d);
+    free(al);
+    free(bl);
+    free(expected);
+}
+
+// Check a Newton division against the schoolbook method
+void check_div(size_t n_size, size_t d_size) {
+    bigint n = random_bigint(n_size);
+    bigint d = random_bigint(d_size);
+    bigint r;
+    bigint q = bigint_divmod(n, d, &r);
+    int64_t *q2 = malloc(n.size * sizeof(int64_t));
+    int64_t *r2 = malloc(d.size * sizeof(int64_t));
+    bigint_digits_divmod(n.digits, n.size, d.digits, d.size, q2, r2);
+    size_t offset = n.size - q.size;
+    for (size_t i = 0; i < offset; i++) {
+        assert(q2[i] == 0);
+    }
+    assert(memcmp(q.digits, q2 + offset, q.size * sizeof(int64_t)) == 0);
+    offset = d.size - r.size;
+    assert(memcmp(r.digits, r2 + offset, r.size * sizeof(int64_t)) == 0);
+    bigint_delete(n);
+    bigint_delete(d);
+    bigint_delete(q);
+    bigint_delete(r);
+    free(q2);
+    free(r2);
+}
+
+// Check that x is the smallest root with x * x >= n
+void check_sqrt(bigint n) {
+    bigint x = bigint_sqrt(n);
+    bigint square = bigint_mul(x, x);
+    assert(!bigint_lt(square, n));
+    bigint_delete(square);
+    bigint below = bigint_sub_ui(x, 1);
+    square = bigint_mul(below, below);
+    assert(bigint_lt(square, n));
+    bigint_delete(square);
+    bigint_delete(below);
+    bigint_delete(x);
+}
+
+// The terms of e = sum 1 / n!, with p(n) = 1 and q(n) = max(n, 1)
+bigint e_p(uint64_t n, void *data) {
+    (void)n;
+    (void)data;
+    return bigint_from_int(1);
+}
+
+bigint e_q(uint64_t n, void *data) {
+    (void)data;
+    return bigint_from_int(n > 0 ? (int64_t)n : 1);
+}
+
+// The terms of the Chudnovsky series for 426880 sqrt(10005) / pi
+bigint chudnovsky_p(uint64_t k, void *data) {
+    (void)data;
+    if (k == 0) {
+        return bigint_from_int(1);
+    }
+    bigint result = bigint_from_int(-(int64_t)(6 * k - 5));
+    bigint_mul_ui_inplace(&result, 2 * k - 1);
+    bigint_mul_ui_inplace(&result, 6 * k - 1);
+    return result;
+}
+
+bigint chudnovsky_q(uint64_t k, void *data) {
+    (void)data;
+    if (k == 0) {
+        return bigint_from_int(1);
+    }
+    bigint result = bigint_from_int(10939058860032000LL);
+    bigint_mul_ui_inplace(&result, k);
+    bigint_mul_ui_inplace(&result, k);
+    bigint_mul_ui_inplace(&result, k);
+    return result;
+}
+
+bigint chudnovsky_a(uint64_t k, void *data) {
+    (void)data;
+    bigint result = bigint_from_int(545140134);
+    bigint_mul_ui_inplace(&result, k);
+    return bigint_add_ui_inplace(&result, 13591409);
+}
+
+// floor(10^digits * sum 1 / n!) by repeated division
+bigint naive_e(size_t digits) {
+    bigint term = bigint_digits_power(digits);
+    bigint sum = bigint_zero();
+    for (uint64_t n = 1; !bigint_eqzero(term); n++) {
+        bigint next = bigint_add(sum, term);
+        bigint_delete(sum);
+        sum = next;
+        uint64_t remainder;
+        next = bigint_divmod_ui(term, n, &remainder);
+        bigint_delete(term);
+        term = next;
+    }
+    bigint_delete(term);
+    return sum;
+}
+
+// 10^digits * arctan(1 / x), with terms truncated toward zero
+bigint naive_arctan(uint64_t x, size_t digits) {
+    uint64_t remainder;
+    bigint power = bigint_digits_power(digits);
+    bigint term = bigint_divmod_ui(power, x, &remainder);
+    bigint sum = bigint_zero();
+    bigint_delete(power);
+    for (uint64_t n = 0; !bigint_eqzero(term); n++) {
+        bigint part = bigint_divmod_ui(term, 2 * n + 1, &remainder);
+        bigint next = n % 2 == 0 ? bigint_add(sum, part) : bigint_sub(sum, part);
+        bigint_delete(sum);
+        bigint_delete(part);
+        sum = next;
+        next = bigint_divmod_ui(term, x * x, &remainder);
+        bigint_delete(term);
+        term = next;
+    }
+    bigint_delete(term);
+    return sum;
+}
+
+#ifdef BIGINT_POSIX
+// Check an out-of-core product of a file-backed operand against bigint_mul
+void check_mul_ooc(size_t a_size, size_t b_size, size_t block) {
+    bigint a = random_bigint(a_size);
+    bigint b = random_bigint(b_size);
+    b.is_negative = a_size % 2 == 1;
+    bigint mapped;
+    assert(bigint_map(NULL, a, &mapped));
+    assert(bigint_is_mapped(mapped) && !bigint_is_mapped(a));
+    assert(bigint_eq(mapped, a));
+    bigint product;
+    assert(bigint_mul_ooc(mapped, b, NULL, block, &product));
+    bigint expected = bigint_mul(a, b);
+    assert(bigint_eq(product, expected));
+    bigint_delete(a);
+    bigint_delete(b);
+    bigint_delete(mapped);
+    bigint_delete(product);
+    bigint_delete(expected);
+}
+
+// Map and free bigints alongside heap bigints, for the registry's unlocked checks
+void *map_and_free(void *arg) {
+    bigint n = bigint_from_int((int64_t)(size_t)arg);
+    for (size_t i = 0; i < 50; i++) {
+        bigint mapped, copy = bigint_copy(n);
+        assert(bigint_map(NULL, n, &mapped));
+        assert(bigint_is_mapped(mapped) && !bigint_is_mapped(copy));
+        assert(bigint_eq(mapped, copy));
+        bigint_delete(copy);
+        bigint_delete(mapped);
+    }
+    bigint_delete(n);
+    return NULL;
+}
+#endif
+
+int main() {
+    // NTT products on both sides of the threshold, including unbalanced ones
+    check_mul(100, 100);
+    check_mul(200, 170);
+    check_mul(1000, 999);
+    check_mul(3001, 2000);
+    check_mul(5000, 400);
+
+    // Newton division for long and short quotients
+    check_div(400, 200);
+    check_div(401, 160);
+    check_div(1000, 500);
+    check_div(2500, 200);
+    check_div(3000, 1900);
+
+    // Exact and inexact square roots
+    for (size_t size = 1; size < 400; size += 37) {
+        bigint n = random_bigint(size);
+        check_sqrt(n);
+        bigint square = bigint_mul(n, n);
+        bigint root = bigint_sqrt(square);
+        assert(bigint_eq(root, n));
+        bigint_delete(root);
+        bigint_add_ui_inplace(&square, 1);
+        check_sqrt(square);
+        bigint_sub_ui_inplace(&square, 2);
+        check_sqrt(square);
+        bigint_delete(square);
+        bigint_delete(n);
+    }
+    bigint zero = bigint_zero();
+    bigint root = bigint_sqrt(zero);
+    assert(bigint_eqzero(root));
+    bigint_delete(root);
+    bigint_delete(zero);
+
+#ifdef BIGINT_POSIX
+    // Out-of-core products over many blocks, a single block, uneven operands and 2-digit limbs
+    check_mul_ooc(1, 1, 4);
+    check_mul_ooc(41, 33, 4);
+    check_mul_ooc(1000, 999, 16);
+    check_mul_ooc(5001, 300, 64);
+    check_mul_ooc(300, 5000, 1024);
+    check_mul_ooc(3000, 2000, 0);
+    check_mul_ooc(4000, 3000, 0);
+    check_mul_ooc(2003, 9001, 8);
+
+    // File-backed operands work with the ordinary API, whose results live on the heap
+    bigint a = random_bigint(2000), b = random_bigint(1500), ma, mb;
+    assert(bigint_map("test14_a.big", a, &ma) && bigint_map(NULL, b, &mb));
+    bigint product = bigint_mul(ma, mb);
+    bigint expected = bigint_mul(a, b);
+    assert(!bigint_is_mapped(product) && bigint_eq(product, expected));
+    bigint_mul_ui_inplace(&product, 12345);
+    bigint_mul_ui_inplace(&expected, 12345);
+    assert(bigint_eq(product, expected));
+    bigint sum = bigint_add(ma, mb);
+    bigint expected_sum = bigint_add(a, b);
+    assert(bigint_eq(sum, expected_sum));
+    bigint reopened;
+    assert(chmod("test14_a.big", 0444) == 0);
+    assert(bigint_map_open("test14_a.big", &reopened) && bigint_eq(reopened, a));
+
+    // Writing to a mapped bigint faults and leaves the file alone
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) {
+        reopened.digits[0] = 9;
+        _exit(0);
+    }
+    int status;
+    assert(child > 0 && waitpid(child, &status, 0) == child);
+    // Sanitizers turn the fault into an error exit, so only a clean exit means the write went through
+    assert(!WIFEXITED(status) || WEXITSTATUS(status) != 0);
+    bigint_delete(reopened);
+    assert(bigint_map_open("test14_a.big", &reopened) && bigint_eq(reopened, a));
+    bigint_delete(reopened);
+    assert(bigint_mappings.count == 2);
+    bigint_delete(ma);
+    bigint_delete(mb);
+    assert(bigint_mappings.count == 0);
+    bigint_delete(product);
+    remove("test14_a.big");
+
+    // Mappings freed out of order, and from several threads at once
+    bigint mapped[5];
+    for (size_t i = 0; i < 5; i++) {
+        bigint value = bigint_from_int((int64_t)i * 1000 + 7);
+        assert(bigint_map(NULL, value, &mapped[i]));
+        bigint_delete(value);
+    }
+    assert(bigint_mappings.count == 5);
+    bigint_delete(mapped[2]);
+    bigint_delete(mapped[0]);
+    bigint_delete(mapped[4]);
+    assert(bigint_mappings.count == 2 && bigint_is_mapped(mapped[1]) && bigint_is_mapped(mapped[3]));
+    bigint_delete(mapped[1]);
+    bigint_delete(mapped[3]);
+    assert(bigint_mappings.count == 0);
+#ifdef BIGINT_THREADS
+    pthread_t mappers[4];
+    for (size_t t = 0; t < 4; t++) {
+        assert(pthread_create(&mappers[t], NULL, map_and_free, (void *)(t + 1)) == 0);
+    }
+    for (size_t t = 0; t < 4; t++) {
+        pthread_join(mappers[t], NULL);
+    }
+    assert(bigint_mappings.count == 0);
+#endif
+    bigint_delete(a);
+    bigint_delete(b);
+    bigint_delete(expected);
+    bigint_delete(sum);
+    bigint_delete(expected_sum);
+#endif
+
+    // e by binary splitting, against the sum of truncated terms
+    size_t digits = 1000;
+    bigint_series e_series = {e_p, e_q, NULL, NULL};
+    bigint e = bigint_series_fixed(e_series, 500, digits + 10);
+    bigint e_low = bigint_digits_truncate(e, 10);
+    bigint e_naive = naive_e(digits + 10);
+    bigint e_naive_low = bigint_digits_truncate(e_naive, 10);
+    assert(bigint_eq(e_low, e_naive_low));
+    bigint_delete(e);
+    bigint_delete(e_low);
+    bigint_delete(e_naive);
+    bigint_delete(e_naive_low);
+
+    // The partial products of a split range merge like the whole range
+    bigint_bsplit whole = bigint_series_bsplit(e_series, 0, 40);
+    bigint_bsplit left = bigint_series_bsplit(e_series, 0, 17);
+    bigint_bsplit right = bigint_series_bsplit(e_series, 17, 40);
+    bigint q = bigint_mul(left.q, right.q);
+    assert(bigint_eq(q, whole.q));
+    bigint tq = bigint_mul(left.t, right.q);
+    bigint pt = bigint_mul(left.p, right.t);
+    bigint t = bigint_add(tq, pt);
+    assert(bigint_eq(t, whole.t));
+    bigint_delete(q);
+    bigint_delete(tq);
+    bigint_delete(pt);
+    bigint_delete(t);
+    bigint_bsplit_delete(whole);
+    bigint_bsplit_delete(left);
+    bigint_bsplit_delete(right);
+
+    // pi = 426880 sqrt(10005) Q / T, with about 14 digits per term
+    bigint_series pi_series = {chudnovsky_p, chudnovsky_q, chudnovsky_a, NULL};
+    size_t guard = 10;
+    bigint_bsplit split = bigint_series_bsplit(pi_series, 0, digits / 14 + 2);
+    bigint radicand = bigint_from_int(10005);
+    bigint scaled = bigint_digits_scale(radicand, 2 * (digits + guard));
+    bigint sqrt_10005 = bigint_sqrt(scaled);
+    bigint numerator = bigint_mul(sqrt_10005, split.q);
+    bigint_mul_ui_inplace(&numerator, 426880);
+    bigint remainder;
+    bigint pi = bigint_divmod(numerator, split.t, &remainder);
+    bigint pi_low = bigint_digits_truncate(pi, guard);
+    bigint_delete(remainder);
+    bigint_delete(numerator);
+    bigint_delete(sqrt_10005);
+    bigint_delete(scaled);
+    bigint_delete(radicand);
+    bigint_bsplit_delete(split);
+
+    // Machin: pi = 16 arctan(1/5) - 4 arctan(1/239)
+    bigint a5 = naive_arctan(5, digits + guard);
+    bigint a239 = naive_arctan(239, digits + guard);
+    bigint_mul_ui_inplace(&a5, 16);
+    bigint_mul_ui_inplace(&a239, 4);
+    bigint machin = bigint_sub(a5, a239);
+    bigint machin_low = bigint_digits_truncate(machin, guard);
+    assert(bigint_eq(pi_low, machin_low));
+
+    const char *prefix = "314159265358979323846264338327950288419716939937510";
+    assert(pi_low.size == digits + 1);
+    for (size_t i = 0; prefix[i]; i++) {
+        assert(pi_low.digits[i] == prefix[i] - '0');
+    }
+    bigint_delete(a5);
+    bigint_delete(a239);
+    bigint_delete(machin);
+    bigint_delete(machin_low);
+    bigint_delete(pi);
+    bigint_delete(pi_low);
+
+    // Test thresholds written to a header and loaded back at runtime
+    assert(bigint_thresholds.ntt == 40);
+    assert(bigint_thresholds.newton_div == 40);
+    assert(bigint_thresholds.karatsuba == BIGINT_KARATSUBA_THRESHOLD);
+    const char *thresholds_path = "test14_thresholds.h";
+    FILE *thresholds_file = fopen(thresholds_path, "w");
+    assert(thresholds_file);
+    assert(bigint_thresholds_write(thresholds_file));
+    fprintf(thresholds_file, "#define BIGINT_UNKNOWN_THRESHOLD 7\n");
+    fclose(thresholds_file);
+    bigint_threshold_table saved = bigint_thresholds;
+    bigint_thresholds.karatsuba = 1000;
+    bigint_thresholds.ntt = 1000;
+    bigint_thresholds.pippenger = 1000;
+    assert(bigint_thresholds_load(thresholds_path));
+    assert(memcmp(&bigint_thresholds, &saved, sizeof(saved)) == 0);
+
+    thresholds_file = fopen(thresholds_path, "w");
+    fprintf(thresholds_file, "// Partial\n#define BIGINT_KARATSUBA_THRESHOLD 8\n#define BIGINT_NEWTON_DIV_THRESHOLD 1\n");
+    fclose(thresholds_file);
+    assert(bigint_thresholds_load(thresholds_path));
+    assert(bigint_thresholds.karatsuba == 8);
+    assert(bigint_thresholds.newton_div == 1);
+    assert(bigint_thresholds.ntt == saved.ntt);
+
+    // Values that would never reach a base case are rejected
+    thresholds_file = fopen(thresholds_path, "w");
+    fprintf(thresholds_file, "#define BIGINT_KARATSUBA_THRESHOLD 2\n#define BIGINT_NTT_THRESHOLD 0\n");
+    fclose(thresholds_file);
+    assert(!bigint_thresholds_load(thresholds_path));
+    assert(bigint_thresholds.karatsuba == 8);
+    assert(bigint_thresholds.ntt == saved.ntt);
+    remove(thresholds_path);
+
+    // Division with Newton's method at every size still terminates
+    bigint dividend = random_bigint(200), small_divisor = random_bigint(3), newton_remainder;
+    bigint quotient = bigint_divmod(dividend, small_divisor, &newton_remainder);
+    bigint product_part = bigint_mul(quotient, small_divisor);
+    bigint check = bigint_add(product_part, newton_remainder);
+    assert(bigint_eq(check, dividend));
+    bigint_delete(product_part);
+    bigint_delete(dividend);
+    bigint_delete(small_divisor);
+    bigint_delete(newton_remainder);
+    bigint_delete(quotient);
+    bigint_delete(check);
+    assert(!bigint_thresholds_load(thresholds_path));
+
+    // Products agree with the schoolbook method under the loaded thresholds
+    bigint operand_a = random_bigint(3000);
+    bigint operand_b = random_bigint(2500);
+    bigint tuned = bigint_mul(operand_a, operand_b);
+    bigint_thresholds.karatsuba = SIZE_MAX;
+    bigint_thresholds.ntt = SIZE_MAX;
+    bigint schoolbook = bigint_mul(operand_a, operand_b);
+    assert(bigint_eq(tuned, schoolbook));
+    bigint_thresholds = saved;
+    bigint_delete(operand_a);
+    bigint_delete(operand_b);
+    bigint_delete(tuned);
+    bigint_delete(schoolbook);
+
+    printf("Test passed\n");
+
+    return 0;
+}
@@ -1,7 +1,25 @@
+// Resolve accumulator carries often
+#define BIGINT_ACC_LIMIT ((uint64_t)1 << 40)
 #include "bigint.h"
 #include <assert.h>
 #include <stdio.h>
 
+// A stream over a string that hands out three characters at a time
+typedef struct {
+    const char *text;
+    size_t offset;
+} string_source;
+
+bool string_read(void *context, char *buffer, size_t size, size_t *count) {
+    string_source *source = context;
+    size_t left = strlen(source->text + source->offset);
+    *count = left < 3 ? left : 3;
+    *count = *count < size ? *count : size;
+    memcpy(buffer, source->text + source->offset, *count);
+    source->offset += *count;
+    return true;
+}
+
 int main() {
 
     // Test the bigint_from_int function
@@ -11,6 +29,212 @@ int main() {
     bigint_delete(x);
     bigint_delete(y);
 
+    // Test parsing with signs, whitespace, leading zeros and explicit lengths
+    assert(bigint_parse(" +000123456789012345678 \n", 25, &x));
+    y = bigint_from_string("123456789012345678");
+    assert(bigint_eq(x, y) && x.size == 18);
+    bigint_delete(x);
+    bigint_delete(y);
+    assert(bigint_parse("-4200junk", 4, &x));
+    assert(bigint_cmp_si(x, -420) == 0);
+    bigint_delete(x);
+    assert(bigint_parse("-000", 4, &x));
+    assert(bigint_eqzero(x) && !x.is_negative && x.size == 1);
+    bigint_delete(x);
+    const char *invalid[] = {"", "   ", "+", "-", "1 2", "12345678:", "1234567/9", "--1", "0x10", "123456789012345a"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        assert(!bigint_parse(invalid[i], strlen(invalid[i]), &x));
+    }
+
+    // Test streaming reads in small chunks and writes through a file
+    string_source source = {"  -0001234567890123456789000\n", 0};
+    assert(bigint_read_stream(string_read, &source, &x));
+    y = bigint_from_string("-1234567890123456789000");
+    assert(bigint_eq(x, y));
+    bigint_delete(x);
+    bigint_delete(y);
+    const char *invalid_streams[] = {"", " \n ", "-", "12 3", "12-", "+ 1", "1234567890123x"};
+    for (size_t i = 0; i < sizeof(invalid_streams) / sizeof(invalid_streams[0]); i++) {
+        string_source bad = {invalid_streams[i], 0};
+        assert(!bigint_read_stream(string_read, &bad, &x));
+    }
+
+    char *text = malloc(200001);
+    for (size_t i = 0; i < 200000; i++) {
+        text[i] = '1' + i % 9;
+    }
+    text[200000] = '\0';
+    x = bigint_from_string(text);
+    FILE *file = tmpfile();
+    assert(bigint_fwrite(file, x));
+    rewind(file);
+    assert(bigint_fread(file, &y));
+    assert(bigint_eq(x, y));
+    fclose(file);
+    bigint_delete(y);
+#ifdef BIGINT_POSIX
+    file = tmpfile();
+    int fd = fileno(file);
+    assert(bigint_fdwrite(fd, x));
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    assert(bigint_fdread(fd, &y));
+    assert(bigint_eq(x, y));
+    fclose(file);
+    bigint_delete(y);
+#endif
+    bigint_delete(x);
+    free(text);
+
+    // Test hashing, which ignores leading zeros and the sign of zero
+    x = bigint_from_string("123456789012345678901234567890123456789");
+    assert(bigint_hash(x, 0) == 11094865140089195161ULL);
+    assert(bigint_hash(x, 0) != bigint_hash(x, 1));
+    y = bigint_digits_scale(x, 0);
+    y.digits[0] = 0;
+    assert(bigint_hash(x, 0) != bigint_hash(y, 0));
+    bigint_delete(y);
+    y = bigint_from_string("-123456789012345678901234567890123456789");
+    assert(bigint_hash(x, 0) != bigint_hash(y, 0));
+    bigint_delete(y);
+    y = bigint_from_string("0");
+    bigint negative_zero = bigint_from_string("0");
+    negative_zero.is_negative = true;
+    assert(bigint_hash(y, 7) == bigint_hash(negative_zero, 7));
+    bigint_delete(negative_zero);
+    bigint padded = {false, calloc(x.size + 3, sizeof(int64_t)), x.size + 3};
+    memcpy(padded.digits + 3, x.digits, x.size * sizeof(int64_t));
+    assert(bigint_hash(padded, 5) == bigint_hash(x, 5));
+
+    // Test interning, where equal values share one instance
+    bigint_intern_table table = bigint_intern_new(42);
+    const bigint *canonical = bigint_intern(&table, padded);
+    assert(canonical == bigint_intern(&table, x));
+    assert(canonical->size == x.size && bigint_eq(*canonical, x));
+    assert(bigint_intern(&table, y) != canonical);
+    for (int64_t i = 0; i < 1000; i++) {
+        bigint value = bigint_from_int(i * 1000003);
+        bigint_intern(&table, value);
+        bigint_delete(value);
+    }
+    // Zero was interned already
+    assert(table.count == 1001);
+    assert(canonical == bigint_intern(&table, x));
+    bigint value = bigint_from_int(999 * 1000003);
+    const bigint *last = bigint_intern(&table, value);
+    assert(bigint_eq(*last, value) && table.count == 1001);
+    bigint_delete(value);
+    bigint_intern_delete(&table);
+    bigint_delete(padded);
+    bigint_delete(x);
+    bigint_delete(y);
+
+    // Test the accumulator against repeated additions
+    bigint_acc acc = bigint_acc_new();
+    x = bigint_acc_value(&acc);
+    assert(bigint_eqzero(x));
+    bigint_delete(x);
+    bigint expected = bigint_zero();
+    uint64_t state = 1;
+    for (size_t i = 0; i < 300; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t size = 1 + (state >> 40) % 60;
+        char digits[64];
+        for (size_t j = 0; j < size; j++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            digits[j] = '0' + (state >> 33) % 10;
+        }
+        digits[size] = '\0';
+        x = bigint_from_string(digits);
+        x.is_negative = state % 3 == 0 && !bigint_eqzero(x);
+        uint64_t k = state % 7 == 0 ? UINT64_MAX - state % 1000 : state >> 50;
+        bigint term;
+        switch (i % 4) {
+        case 0:
+            bigint_acc_add(&acc, x);
+            term = bigint_copy(x);
+            break;
+        case 1:
+            bigint_acc_sub(&acc, x);
+            term = bigint_copy(x);
+            term.is_negative = !term.is_negative && !bigint_eqzero(term);
+            break;
+        case 2:
+            bigint_acc_addmul_ui(&acc, x, k);
+            y = bigint_from_int((int64_t)(k / 2));
+            term = bigint_mul(x, y);
+            bigint_delete(y);
+            y = bigint_add(term, term);
+            bigint_delete(term);
+            term = k % 2 ? bigint_add(y, x) : bigint_copy(y);
+            bigint_delete(y);
+            break;
+        default:
+            y = bigint_from_string(digits + size / 2);
+            bigint_acc_addmul(&acc, x, y);
+            term = bigint_mul(x, y);
+            bigint_delete(y);
+            break;
+        }
+        y = bigint_add(expected, term);
+        bigint_delete(expected);
+        bigint_delete(term);
+        bigint_delete(x);
+        expected = y;
+        if (i % 50 == 49) {
+            x = bigint_acc_value(&acc);
+            assert(bigint_eq(x, expected));
+            bigint_delete(x);
+        }
+    }
+    bigint_acc_sub(&acc, expected);
+    x = bigint_acc_value(&acc);
+    assert(bigint_eqzero(x) && !x.is_negative);
+    bigint_delete(x);
+    bigint_acc_clear(&acc);
+    y = bigint_from_string("-5");
+    bigint_acc_add(&acc, y);
+    x = bigint_acc_value(&acc);
+    assert(bigint_eq(x, y));
+    bigint_delete(x);
+    bigint_delete(y);
+    bigint_delete(expected);
+    bigint_acc_delete(&acc);
+
+    // Test views and slices, which share digits with their source
+    x = bigint_from_string("-123456789012345678901234567890");
+    bigint_view view = bigint_view_of(x);
+    bigint high = bigint_from_view(bigint_view_slice(view, 10, 100));
+    bigint low = bigint_from_view(bigint_view_slice(view, 0, 10));
+    assert(high.digits == x.digits && bigint_cmp_si(low, -1234567890) == 0);
+    y = bigint_from_string("-12345678901234567890");
+    assert(bigint_eq(high, y));
+    bigint_delete(y);
+    y = bigint_digits_scale(high, 10);
+    bigint joined = bigint_add(y, low);
+    assert(bigint_eq(joined, x));
+    bigint_delete(y);
+    bigint_delete(joined);
+    y = bigint_from_view(bigint_view_slice(view, 30, 5));
+    assert(bigint_eqzero(y));
+
+    // A slice with leading zeros reads like its value, and comparisons leave its digits in place
+    bigint middle = bigint_from_view(bigint_view_slice(view, 3, 8));
+    assert(middle.size == 8 && middle.digits[0] == 0);
+    assert(bigint_cmp_si(middle, -1234567) == 0);
+    assert(bigint_gt(middle, low) && bigint_gt(middle, high) && bigint_ltzero(middle));
+    y = bigint_from_int(-1234567);
+    assert(bigint_eq(middle, y) && bigint_eq(y, middle));
+    bigint_delete(y);
+    y = bigint_mul(middle, high);
+    bigint product = bigint_from_string("15241567764060456776253630");
+    assert(bigint_eq(y, product));
+    bigint_delete(y);
+    bigint_delete(product);
+    y = bigint_from_string("-123456789012345678901234567890");
+    assert(bigint_eq(x, y));
+    bigint_delete(y);
+    bigint_delete(x);
+
     // Test comparison functions
     x = bigint_from_int(100);
     y = bigint_from_int(100);
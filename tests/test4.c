@@ -0,0 +1,99 @@
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+
+bigint naive_factorial(int64_t n) {
+    bigint tmp1, tmp2;
+    bigint result = bigint_from_int(1);
+    for (int64_t i = 2; i <= n; i++) {
+        tmp1 = result;
+        tmp2 = bigint_from_int(i);
+        result = bigint_mul(result, tmp2);
+        bigint_delete(tmp1);
+        bigint_delete(tmp2);
+    }
+    return result;
+}
+
+int main() {
+    // Test the factorial against the naive product
+    for (int64_t n = 0; n <= 300; n += 37) {
+        bigint x = bigint_fac_ui(n);
+        bigint y = naive_factorial(n);
+        assert(bigint_eq(x, y));
+        bigint_delete(x);
+        bigint_delete(y);
+    }
+
+    bigint x = bigint_fac_ui(100);
+    bigint y = bigint_from_string("93326215443944152681699238856266700490715968264381621468592963895217599993229915608941463976156518286253697920827223758251185210916864000000000000000000000000");
+    assert(bigint_eq(x, y));
+    bigint_delete(x);
+    bigint_delete(y);
+
+    // Test Karatsuba multiplication: (10^600 - 1)^2 = 10^1200 - 2 * 10^600 + 1
+    char nines[601], square[1201];
+    memset(nines, '9', 600);
+    nines[600] = '\0';
+    memset(square, '9', 599);
+    square[599] = '8';
+    memset(square + 600, '0', 599);
+    square[1199] = '1';
+    square[1200] = '\0';
+    x = bigint_from_string(nines);
+    y = bigint_from_string(square);
+    bigint z = bigint_mul(x, x);
+    assert(bigint_eq(z, y));
+    bigint_delete(x);
+    bigint_delete(y);
+    bigint_delete(z);
+
+    // Test binomial coefficients
+    x = bigint_bin_ui(100, 50);
+    y = bigint_from_string("100891344545564193334812497256");
+    assert(bigint_eq(x, y));
+    bigint_delete(x);
+    bigint_delete(y);
+
+    x = bigint_bin_ui(10, 11);
+    assert(bigint_eqzero(x));
+    bigint_delete(x);
+
+    x = bigint_bin_ui(1000, 0);
+    y = bigint_from_int(1);
+    assert(bigint_eq(x, y));
+    bigint_delete(x);
+    bigint_delete(y);
+
+    // n! = C(n, k) * k! * (n - k)!
+    x = bigint_fac_ui(2000);
+    y = bigint_bin_ui(2000, 700);
+    z = bigint_fac_ui(700);
+    bigint t = bigint_mul(y, z);
+    bigint_delete(z);
+    z = bigint_fac_ui(1300);
+    bigint r = bigint_mul(t, z);
+    assert(bigint_eq(x, r));
+    bigint_delete(x);
+    bigint_delete(y);
+    bigint_delete(z);
+    bigint_delete(t);
+    bigint_delete(r);
+
+    // Test primorials
+    x = bigint_primorial_ui(30);
+    y = bigint_from_int(6469693230);
+    assert(bigint_eq(x, y));
+    bigint_delete(x);
+    bigint_delete(y);
+
+    x = bigint_primorial_ui(1);
+    y = bigint_from_int(1);
+    assert(bigint_eq(x, y));
+    bigint_delete(x);
+    bigint_delete(y);
+
+    printf("Test passed\n");
+
+    return 0;
+}
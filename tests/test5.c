@@ -0,0 +1,208 @@
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+
+uint64_t seed = 12345;
+
+// Create a random bigint with the given number of digits
+bigint random_bigint(size_t size) {
+    char *digits = malloc(size + 1);
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        digits[i] = '0' + (seed >> 33) % 10;
+    }
+    if (digits[0] == '0') {
+        digits[0] = '1';
+    }
+    digits[size] = '\0';
+    bigint result = bigint_from_string(digits);
+    free(digits);
+    return result;
+}
+
+int main() {
+    // Test long division: n = q * d + r with 0 <= r < d
+    for (size_t i = 0; i < 50; i++) {
+        bigint n = random_bigint(20 + i * 3);
+        bigint d = random_bigint(10 + i);
+        bigint r;
+        bigint q = bigint_divmod(n, d, &r);
+        bigint t = bigint_mul(q, d);
+        bigint s = bigint_add(t, r);
+        assert(bigint_eq(s, n));
+        assert(bigint_gezero(r) && bigint_lt(r, d));
+        bigint_delete(n);
+        bigint_delete(d);
+        bigint_delete(q);
+        bigint_delete(r);
+        bigint_delete(t);
+        bigint_delete(s);
+    }
+
+    // Test Barrett reduction against bigint_mod, for odd and even moduli
+    for (size_t i = 0; i < 20; i++) {
+        bigint m = random_bigint(15 + i);
+        bigint_modctx ctx = bigint_modctx_new(m);
+        for (size_t j = 0; j < 10; j++) {
+            bigint x = random_bigint(5 + j * 9);
+            bigint r1 = bigint_modred(ctx, x);
+            bigint r2 = bigint_mod(x, m);
+            assert(bigint_eq(r1, r2));
+            bigint_delete(r1);
+            bigint_delete(r2);
+
+            // Negative values reduce into [0, m)
+            x.is_negative = true;
+            r1 = bigint_modred(ctx, x);
+            r2 = bigint_sub(r1, x);
+            bigint r3 = bigint_mod(r2, m);
+            assert(bigint_gezero(r1) && bigint_lt(r1, m));
+            assert(bigint_eqzero(r3));
+            bigint_delete(r1);
+            bigint_delete(r2);
+            bigint_delete(r3);
+            bigint_delete(x);
+        }
+
+        bigint a = random_bigint(10 + i);
+        bigint b = random_bigint(12 + i);
+        bigint r1 = bigint_modmul(ctx, a, b);
+        bigint t = bigint_mul(a, b);
+        bigint r2 = bigint_mod(t, m);
+        assert(bigint_eq(r1, r2));
+        bigint_delete(r1);
+        bigint_delete(r2);
+        bigint_delete(t);
+
+        bigint ra = bigint_modred(ctx, a), rb = bigint_modred(ctx, b);
+        bigint sum = bigint_modadd(ctx, ra, rb);
+        bigint diff = bigint_modsub(ctx, sum, rb);
+        assert(bigint_eq(diff, ra));
+        assert(bigint_lt(sum, m));
+        bigint_delete(ra);
+        bigint_delete(rb);
+        bigint_delete(sum);
+        bigint_delete(diff);
+
+        bigint_delete(a);
+        bigint_delete(b);
+        bigint_delete(m);
+        bigint_modctx_delete(ctx);
+    }
+
+    // Fermat's little theorem with the Mersenne prime 2^127 - 1
+    bigint p = bigint_from_string("170141183460469231731687303715884105727");
+    bigint e = bigint_from_string("170141183460469231731687303715884105726");
+    bigint a = bigint_from_string("123456789123456789123456789");
+    bigint r = bigint_fast_pow(a, e, p);
+    bigint one = bigint_from_int(1);
+    assert(bigint_eq(r, one));
+    bigint_delete(p);
+    bigint_delete(e);
+    bigint_delete(a);
+    bigint_delete(r);
+    bigint_delete(one);
+
+    // 3^100 mod 10^20
+    a = bigint_from_int(3);
+    e = bigint_from_int(100);
+    bigint m = bigint_from_string("100000000000000000000");
+    r = bigint_fast_pow(a, e, m);
+    bigint expected = bigint_from_string("65621272702107522001");
+    assert(bigint_eq(r, expected));
+    bigint_delete(a);
+    bigint_delete(e);
+    bigint_delete(m);
+    bigint_delete(r);
+    bigint_delete(expected);
+
+    // Moduli of the form 10^split - c fold instead of using Barrett reduction
+    const char *special[] = {
+        "9999999999999999999999999999999999999913",
+        "100000000000000000000000000000000000000000000000151",
+        "9999991",
+    };
+    for (size_t i = 0; i < 3; i++) {
+        m = bigint_from_string(special[i]);
+        bigint_modctx ctx = bigint_modctx_new(m);
+        assert(ctx.kind == BIGINT_MODCTX_DECIMAL);
+        for (size_t j = 0; j < 20; j++) {
+            bigint x = random_bigint(1 + j * 9);
+            x.is_negative = j % 3 == 0;
+            bigint r1 = bigint_modred(ctx, x);
+            bigint r2 = bigint_mod(x, m);
+            if (bigint_ltzero(r2)) {
+                bigint tmp = r2;
+                r2 = bigint_add(r2, m);
+                bigint_delete(tmp);
+            }
+            assert(bigint_eq(r1, r2));
+            bigint_delete(x);
+            bigint_delete(r1);
+            bigint_delete(r2);
+        }
+        bigint_modctx_delete(ctx);
+        bigint_delete(m);
+    }
+
+    // An explicit form with a larger offset, and a modulus with no special form
+    bigint c = bigint_from_string("-1234567891234567891234567");
+    bigint_modctx special_ctx = bigint_modctx_new_special(40, c);
+    m = bigint_from_string("10000000000000001234567891234567891234567");
+    assert(bigint_eq(special_ctx.m, m));
+    bigint_modctx barrett_ctx = bigint_modctx_new(m);
+    assert(barrett_ctx.kind == BIGINT_MODCTX_BARRETT);
+    for (size_t j = 0; j < 20; j++) {
+        bigint x = random_bigint(10 + j * 7);
+        bigint r1 = bigint_modred(special_ctx, x);
+        bigint r2 = bigint_modred(barrett_ctx, x);
+        assert(bigint_eq(r1, r2));
+        bigint_delete(x);
+        bigint_delete(r1);
+        bigint_delete(r2);
+    }
+    bigint_modctx_delete(special_ctx);
+    bigint_modctx_delete(barrett_ctx);
+    bigint_delete(c);
+    bigint_delete(m);
+
+    // Batch inversion agrees with bigint_modinv, and reports the values sharing a factor with m
+    m = bigint_from_string("100000300000000000000000000000000000000000000000151000453");
+    bigint values[40];
+    bigint inverses[40];
+    for (size_t i = 0; i < 40; i++) {
+        values[i] = random_bigint(10 + i * 2);
+    }
+    values[3].is_negative = true;
+    bigint_delete(values[7]);
+    values[7] = bigint_zero();
+    bigint_delete(values[11]);
+    values[11] = bigint_copy(m);
+    bigint_delete(values[20]);
+    // m = 1000003 * (10^50 + 151)
+    values[20] = bigint_from_int(1000003LL * 12345);
+    bigint_modctx ctx = bigint_modctx_new(m);
+    assert(bigint_modinv_batch(ctx, values, 40, inverses) == 3);
+    for (size_t i = 0; i < 40; i++) {
+        if (i == 7 || i == 11 || i == 20) {
+            assert(bigint_eqzero(inverses[i]));
+        } else {
+            bigint check = bigint_modmul(ctx, values[i], inverses[i]);
+            assert(bigint_cmp_si(check, 1) == 0);
+            bigint_delete(check);
+        }
+        if (!values[i].is_negative) {
+            bigint one_by_one = bigint_modinv(values[i], m);
+            assert(bigint_eq(one_by_one, inverses[i]));
+            bigint_delete(one_by_one);
+        }
+        bigint_delete(values[i]);
+        bigint_delete(inverses[i]);
+    }
+    bigint_modctx_delete(ctx);
+    bigint_delete(m);
+
+    printf("Test passed\n");
+
+    return 0;
+}
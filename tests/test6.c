@@ -0,0 +1,106 @@
+// Split RNS operations across a pool of threads even for small bases
+#define BIGINT_RNS_THREAD_WORK 8
+#define BIGINT_POOL_THREADS 4
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+
+uint64_t seed = 6789;
+
+// Create a random bigint with the given number of digits
+bigint random_bigint(size_t size) {
+    char *digits = malloc(size + 1);
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        digits[i] = '0' + (seed >> 33) % 10;
+    }
+    if (digits[0] == '0') {
+        digits[0] = '1';
+    }
+    digits[size] = '\0';
+    bigint result = bigint_from_string(digits);
+    free(digits);
+    return result;
+}
+
+int main() {
+    bigint_rns_base base = bigint_rns_base_new(200);
+    assert(base.count >= 8);
+
+    // Round trip through residues
+    for (size_t i = 1; i < 200; i += 17) {
+        bigint x = random_bigint(i);
+        x.is_negative = i % 2 == 0;
+        bigint_rns r = bigint_rns_from_bigint(base, x);
+        bigint y = bigint_rns_to_bigint(base, r);
+        assert(bigint_eq(x, y));
+        bigint_delete(x);
+        bigint_delete(y);
+        bigint_rns_delete(r);
+    }
+
+    // Evaluate a * b - c * d + a in both representations
+    bigint a = random_bigint(90), b = random_bigint(95), c = random_bigint(99), d = random_bigint(98);
+    a.is_negative = true;
+    bigint_rns ra = bigint_rns_from_bigint(base, a);
+    bigint_rns rb = bigint_rns_from_bigint(base, b);
+    bigint_rns rc = bigint_rns_from_bigint(base, c);
+    bigint_rns rd = bigint_rns_from_bigint(base, d);
+    bigint_rns rab = bigint_rns_mul(base, ra, rb);
+    bigint_rns rcd = bigint_rns_mul(base, rc, rd);
+    bigint_rns rdiff = bigint_rns_sub(base, rab, rcd);
+    bigint_rns rsum = bigint_rns_add(base, rdiff, ra);
+    bigint result = bigint_rns_to_bigint(base, rsum);
+
+    bigint ab = bigint_mul(a, b), cd = bigint_mul(c, d);
+    bigint diff = bigint_sub(ab, cd);
+    bigint sum = bigint_add(diff, a);
+    assert(bigint_eq(result, sum));
+
+    // The same expression and a * c as one chain, reusing registers
+    bigint_rns values[5] = {bigint_rns_from_bigint(base, a), bigint_rns_from_bigint(base, b),
+                            bigint_rns_from_bigint(base, c), bigint_rns_from_bigint(base, d), bigint_rns_new(base)};
+    bigint_rns_step steps[] = {
+        {BIGINT_RNS_MUL, 4, 0, 1},
+        {BIGINT_RNS_MUL, 1, 2, 3},
+        {BIGINT_RNS_SUB, 4, 4, 1},
+        {BIGINT_RNS_ADD, 4, 4, 0},
+        {BIGINT_RNS_MUL, 3, 0, 2},
+    };
+    bigint_rns_run(base, values, steps, sizeof(steps) / sizeof(steps[0]));
+    bigint chained = bigint_rns_to_bigint(base, values[4]);
+    assert(bigint_eq(chained, sum));
+    bigint_delete(chained);
+    bigint result_ac = bigint_rns_to_bigint(base, values[3]);
+    bigint ac = bigint_mul(a, c);
+    assert(bigint_eq(result_ac, ac));
+    bigint_delete(ac);
+    bigint_delete(result_ac);
+    for (size_t i = 0; i < 5; i++) {
+        bigint_rns_delete(values[i]);
+    }
+
+    bigint_delete(a);
+    bigint_delete(b);
+    bigint_delete(c);
+    bigint_delete(d);
+    bigint_delete(ab);
+    bigint_delete(cd);
+    bigint_delete(diff);
+    bigint_delete(sum);
+    bigint_delete(result);
+    bigint_rns_delete(ra);
+    bigint_rns_delete(rb);
+    bigint_rns_delete(rc);
+    bigint_rns_delete(rd);
+    bigint_rns_delete(rab);
+    bigint_rns_delete(rcd);
+    bigint_rns_delete(rdiff);
+    bigint_rns_delete(rsum);
+
+    bigint_rns_base_delete(base);
+
+    printf("Test passed\n");
+
+    return 0;
+}
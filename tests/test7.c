@@ -0,0 +1,150 @@
+// Shifts over 64 bits multiply or divide by a power of two
+#define BIGINT_SHIFT_MUL_BITS 64
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+
+// Check a bigint against an int64_t
+bool equals(bigint a, int64_t b) {
+    bigint tmp = bigint_from_int(b);
+    bool result = bigint_eq(a, tmp);
+    bigint_delete(tmp);
+    return result;
+}
+
+int main() {
+    // Compare against the C operators on small signed values
+    int64_t values[] = {0, 1, -1, 2, -2, 7, -7, 12345, -12345, 1000000007, -999999937, 4611686018427387, -4611686018427387};
+    size_t count = sizeof(values) / sizeof(values[0]);
+    for (size_t i = 0; i < count; i++) {
+        bigint a = bigint_from_int(values[i]);
+        for (size_t j = 0; j < count; j++) {
+            bigint b = bigint_from_int(values[j]);
+            bigint r = bigint_and(a, b);
+            assert(equals(r, values[i] & values[j]));
+            bigint_delete(r);
+            r = bigint_or(a, b);
+            assert(equals(r, values[i] | values[j]));
+            bigint_delete(r);
+            r = bigint_xor(a, b);
+            assert(equals(r, values[i] ^ values[j]));
+            bigint_delete(r);
+            bigint_delete(b);
+        }
+
+        bigint r = bigint_not(a);
+        assert(equals(r, ~values[i]));
+        bigint_delete(r);
+
+        for (size_t bits = 0; bits < 12; bits += 3) {
+            r = bigint_shl(a, bits);
+            assert(equals(r, values[i] * ((int64_t)1 << bits)));
+            bigint_delete(r);
+            r = bigint_shr(a, bits);
+            assert(equals(r, values[i] >> bits));
+            bigint_delete(r);
+        }
+
+        for (size_t bit = 0; bit < 63; bit++) {
+            assert(bigint_testbit(a, bit) == ((values[i] >> bit) & 1));
+        }
+
+        if (values[i] >= 0) {
+            assert(bigint_popcount(a) == (size_t)__builtin_popcountll(values[i]));
+            assert(bigint_bit_length(a) == (values[i] ? 64 - (size_t)__builtin_clzll(values[i]) : 0));
+        }
+        if (values[i] != 0) {
+            assert(bigint_scan1(a, 0) == (size_t)__builtin_ctzll(values[i]));
+        }
+        bigint_delete(a);
+    }
+
+    // 2^200 round trips through shifts
+    bigint x = bigint_from_int(1);
+    bigint_shl_inplace(&x, 200);
+    bigint y = bigint_from_string("1606938044258990275541962092341162602522202993782792835301376");
+    assert(bigint_eq(x, y));
+    assert(bigint_bit_length(x) == 201);
+    assert(bigint_popcount(x) == 1);
+    assert(bigint_scan1(x, 0) == 200);
+    assert(bigint_testbit(x, 200) && !bigint_testbit(x, 199));
+    bigint_shr_inplace(&x, 199);
+    assert(equals(x, 2));
+    bigint_delete(y);
+
+    // Setting and clearing high bits
+    bigint_setbit(&x, 100);
+    bigint_setbit(&x, 0);
+    assert(bigint_testbit(x, 100) && bigint_testbit(x, 0) && bigint_testbit(x, 1));
+    assert(bigint_popcount(x) == 3);
+    bigint_clrbit(&x, 100);
+    assert(equals(x, 3));
+    bigint_delete(x);
+
+    // -2^100 has bits 100 and above set in two's complement
+    x = bigint_from_int(1);
+    bigint_shl_inplace(&x, 100);
+    x.is_negative = true;
+    assert(bigint_scan1(x, 0) == 100);
+    assert(bigint_scan1(x, 500) == 500);
+    assert(!bigint_testbit(x, 99) && bigint_testbit(x, 100) && bigint_testbit(x, 1000));
+    y = bigint_shr(x, 101);
+    assert(equals(y, -1));
+    bigint_delete(y);
+    bigint_delete(x);
+
+    // Large values agree between the basecase and divide and conquer conversions
+    uint64_t state = 7;
+    bigint m = bigint_random_bits(10000, &state);
+    for (int sign = 0; sign < 2; sign++) {
+        x = bigint_copy(m);
+        x.is_negative = sign;
+        size_t plain_count, dc_count;
+        bigint_thresholds.to_words_dc = bigint_thresholds.from_words_dc = SIZE_MAX;
+        uint32_t *plain = bigint_to_words(x, &plain_count);
+        bigint_thresholds.to_words_dc = bigint_thresholds.from_words_dc = 20;
+        uint32_t *words = bigint_to_words(x, &dc_count);
+        assert(plain_count == dc_count && memcmp(plain, words, dc_count * sizeof(uint32_t)) == 0);
+        y = bigint_from_words(words, dc_count, x.is_negative);
+        assert(bigint_eq(x, y));
+        bigint_delete(y);
+        free(words);
+
+        // Bits of -m are the complements of the bits of m - 1
+        bigint below = bigint_sub_ui(m, 1);
+        size_t below_count;
+        words = bigint_to_words(below, &below_count);
+        for (size_t bit = 0; bit < 10100; bit += 37) {
+            uint32_t word = bit / 32 < (sign ? below_count : plain_count) ? (sign ? words : plain)[bit / 32] : 0;
+            assert(bigint_testbit(x, bit) == (((word >> bit % 32) & 1) != (uint32_t)sign));
+        }
+        free(words);
+        free(plain);
+        bigint_delete(below);
+
+        // One long shift matches many short passes
+        for (size_t bits = 65; bits < 3000; bits += 997) {
+            bigint once = bigint_shr(x, bits), passes = bigint_copy(x);
+            for (size_t done = 0; done < bits; done += 5) {
+                bigint_shr_inplace(&passes, bits - done < 5 ? bits - done : 5);
+            }
+            assert(bigint_eq(once, passes));
+            bigint_delete(once);
+            bigint_delete(passes);
+            once = bigint_shl(x, bits);
+            passes = bigint_copy(x);
+            for (size_t done = 0; done < bits; done += 50) {
+                bigint_shl_inplace(&passes, bits - done < 50 ? bits - done : 50);
+            }
+            assert(bigint_eq(once, passes));
+            bigint_delete(once);
+            bigint_delete(passes);
+        }
+        bigint_delete(x);
+    }
+    bigint_delete(m);
+
+    printf("Test passed\n");
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#define THREADS 4
+#define ROUNDS 10000
+
+bigint_ref shared;
+
+// Copy and drop a shared handle many times while reading it
+void *reader(void *arg) {
+    bigint expected = *(bigint *)arg;
+    for (int i = 0; i < ROUNDS; i++) {
+        bigint_ref ref = bigint_ref_copy(shared);
+        assert(bigint_eq(bigint_ref_get(ref), expected));
+        bigint_ref_delete(ref);
+    }
+    return NULL;
+}
+
+int main() {
+    // Test bigint_swap
+    bigint x = bigint_from_int(100);
+    bigint y = bigint_from_string("123456789012345678901234567890");
+    int64_t *x_digits = x.digits, *y_digits = y.digits;
+    bigint_swap(&x, &y);
+    assert(x.digits == y_digits && y.digits == x_digits);
+    bigint tmp = bigint_from_int(100);
+    assert(bigint_eq(y, tmp));
+    bigint_delete(tmp);
+    bigint_delete(x);
+    bigint_delete(y);
+
+    // Copies share digits until one is modified
+    bigint_ref a = bigint_ref_new(bigint_from_int(42));
+    bigint_ref b = bigint_ref_copy(a);
+    assert(bigint_ref_get(a).digits == bigint_ref_get(b).digits);
+
+    bigint *value = bigint_ref_mut(&b);
+    bigint_inc(value);
+    assert(bigint_ref_get(a).digits != bigint_ref_get(b).digits);
+    tmp = bigint_from_int(42);
+    assert(bigint_eq(bigint_ref_get(a), tmp));
+    bigint_delete(tmp);
+    tmp = bigint_from_int(43);
+    assert(bigint_eq(bigint_ref_get(b), tmp));
+    bigint_delete(tmp);
+
+    // A handle with no other owners is modified in place
+    int64_t *digits = bigint_ref_get(b).digits;
+    assert(bigint_ref_mut(&b)->digits == digits);
+
+    bigint_ref_swap(&a, &b);
+    tmp = bigint_from_int(43);
+    assert(bigint_eq(bigint_ref_get(a), tmp));
+    bigint_delete(tmp);
+    bigint_ref_delete(a);
+    bigint_ref_delete(b);
+
+    // Share one value across threads
+    shared = bigint_ref_new(bigint_fac_ui(200));
+    bigint expected = bigint_fac_ui(200);
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        pthread_create(&threads[i], NULL, reader, &expected);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(shared.shared->refcount == 1);
+    bigint_ref_delete(shared);
+    bigint_delete(expected);
+
+    printf("Test passed\n");
+
+    return 0;
+}
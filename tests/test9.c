@@ -0,0 +1,85 @@
+#include "bigint.h"
+#include <assert.h>
+#include <stdio.h>
+
+int main() {
+    const char *values[] = {"0", "1", "-1", "9", "-10", "999999999999", "-1000000000000", "123456789012345678901234567890", "-98765432109876543210987654321"};
+    uint64_t words[] = {0, 1, 9, 10, 1000000007, 999999999999999999ULL, 18446744073709551615ULL};
+    size_t value_count = sizeof(values) / sizeof(values[0]);
+    size_t word_count = sizeof(words) / sizeof(words[0]);
+
+    for (size_t i = 0; i < value_count; i++) {
+        bigint a = bigint_from_string(values[i]);
+        for (size_t j = 0; j < word_count; j++) {
+            // Compare each word operation with the bigint operation
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)words[j]);
+            bigint b = bigint_from_string(buffer);
+
+            bigint x = bigint_add_ui(a, words[j]);
+            bigint y = bigint_add(a, b);
+            assert(bigint_eq(x, y));
+            bigint_delete(x);
+            bigint_delete(y);
+
+            x = bigint_sub_ui(a, words[j]);
+            y = bigint_sub(a, b);
+            assert(bigint_eqzero(x) ? bigint_eqzero(y) : bigint_eq(x, y));
+            bigint_delete(x);
+            bigint_delete(y);
+
+            x = bigint_mul_ui(a, words[j]);
+            y = bigint_mul(a, b);
+            assert(bigint_eqzero(x) ? bigint_eqzero(y) : bigint_eq(x, y));
+            bigint_delete(x);
+            bigint_delete(y);
+
+            if (words[j] != 0 && words[j] <= UINT64_MAX / 10) {
+                uint64_t rem;
+                bigint r;
+                x = bigint_divmod_ui(a, words[j], &rem);
+                y = bigint_divmod(a, b, &r);
+                r.is_negative = false;
+                assert(bigint_eqzero(x) ? bigint_eqzero(y) : bigint_eq(x, y));
+                assert(bigint_cmp_si(r, (int64_t)rem) == 0);
+                assert(bigint_mod_ui(a, words[j]) == rem);
+                assert(bigint_divisible_ui_p(a, words[j]) == (rem == 0));
+                bigint_delete(x);
+                bigint_delete(y);
+                bigint_delete(r);
+            }
+            bigint_delete(b);
+        }
+        bigint_delete(a);
+    }
+
+    // Test comparisons with signed words
+    bigint a = bigint_from_int(-5);
+    assert(bigint_cmp_si(a, -5) == 0);
+    assert(bigint_cmp_si(a, -6) > 0);
+    assert(bigint_cmp_si(a, 0) < 0);
+    assert(bigint_cmp_si(a, INT64_MIN) > 0);
+    bigint_delete(a);
+    a = bigint_from_string("9223372036854775808");
+    assert(bigint_cmp_si(a, INT64_MAX) > 0);
+    bigint_delete(a);
+    a = bigint_from_string("-0");
+    assert(bigint_cmp_si(a, 0) == 0);
+    bigint_delete(a);
+
+    // Counting across a digit boundary in both directions
+    a = bigint_from_int(-2);
+    for (int64_t i = -2; i <= 1002; i++) {
+        assert(bigint_cmp_si(a, i) == 0);
+        bigint_inc(&a);
+    }
+    for (int64_t i = 1003; i >= -1002; i--) {
+        assert(bigint_cmp_si(a, i) == 0);
+        bigint_dec(&a);
+    }
+    bigint_delete(a);
+
+    printf("Test passed\n");
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Emit BIGINT_CONSTANT declarations from decimal literals
+ *
+ * Usage: bigint_constgen NAME VALUE [NAME VALUE ...]
+ *        bigint_constgen < constants.txt
+ *
+ * With no arguments, whitespace-separated NAME VALUE pairs are read from
+ * standard input. The declarations are written to standard output, ready
+ * to be included after bigint.h.
+ */
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The number of digits written on each line of a declaration
+#define CONSTGEN_DIGITS_PER_LINE 20
+
+// Whether a name is a valid C identifier
+bool constgen_valid_name(const char *name) {
+    if (!isalpha((unsigned char)name[0]) && name[0] != '_') {
+        return false;
+    }
+    for (size_t i = 1; name[i]; i++) {
+        if (!isalnum((unsigned char)name[i]) && name[i] != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Write the declaration of one constant
+* @param out The stream to write to
+* @param name The name of the constant
+* @param value The decimal literal, with an optional sign
+* @return Whether the literal was valid
+*/
+bool constgen_emit(FILE *out, const char *name, const char *value) {
+    bool negative = false;
+    if (*value == '+' || *value == '-') {
+        negative = *value == '-';
+        value++;
+    }
+    if (!*value) {
+        return false;
+    }
+    for (size_t i = 0; value[i]; i++) {
+        if (!isdigit((unsigned char)value[i])) {
+            return false;
+        }
+    }
+    while (value[0] == '0' && value[1]) {
+        value++;
+    }
+    if (strcmp(value, "0") == 0) {
+        negative = false;
+    }
+
+    size_t size = strlen(value);
+    fprintf(out, "BIGINT_CONSTANT(%s, %s,", name, negative ? "true" : "false");
+    for (size_t i = 0; i < size; i++) {
+        if (i % CONSTGEN_DIGITS_PER_LINE == 0) {
+            fprintf(out, "\n   ");
+        }
+        fprintf(out, " %c%s", value[i], i + 1 < size ? "," : "");
+    }
+    fprintf(out, ");\n");
+    return true;
+}
+
+// Check and emit one NAME VALUE pair, reporting errors to stderr
+bool constgen_pair(const char *name, const char *value) {
+    if (!constgen_valid_name(name)) {
+        fprintf(stderr, "bigint_constgen: invalid name '%s'\n", name);
+        return false;
+    }
+    if (!constgen_emit(stdout, name, value)) {
+        fprintf(stderr, "bigint_constgen: invalid decimal literal for '%s'\n", name);
+        return false;
+    }
+    return true;
+}
+
+// Read one whitespace-separated word of any length, or return NULL at the end of input
+char *constgen_read_word(FILE *in) {
+    int c;
+    while ((c = fgetc(in)) != EOF && isspace(c)) {
+    }
+    if (c == EOF) {
+        return NULL;
+    }
+    size_t size = 0, capacity = 64;
+    char *word = malloc(capacity);
+    do {
+        if (size + 1 == capacity) {
+            capacity *= 2;
+            word = realloc(word, capacity);
+        }
+        word[size++] = (char)c;
+    } while ((c = fgetc(in)) != EOF && !isspace(c));
+    word[size] = '\0';
+    return word;
+}
+
+int main(int argc, char **argv) {
+    if (argc % 2 == 0) {
+        fprintf(stderr, "usage: %s NAME VALUE [NAME VALUE ...]\n", argv[0]);
+        return 2;
+    }
+
+    printf("#include \"bigint.h\"\n\n");
+    if (argc > 1) {
+        for (int i = 1; i < argc; i += 2) {
+            if (!constgen_pair(argv[i], argv[i + 1])) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    char *name;
+    while ((name = constgen_read_word(stdin)) != NULL) {
+        char *value = constgen_read_word(stdin);
+        bool ok = value != NULL && constgen_pair(name, value);
+        if (value == NULL) {
+            fprintf(stderr, "bigint_constgen: missing value for '%s'\n", name);
+        }
+        free(name);
+        free(value);
+        if (!ok) {
+            return 1;
+        }
+    }
+    return 0;
+}
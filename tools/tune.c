@@ -0,0 +1,248 @@
+/*
+ * Measure the crossover points between algorithm tiers
+ *
+ * Usage: tune [OUTPUT]
+ *
+ * For each threshold in bigint_thresholds, the sizes between two bounds are
+ * binary searched for the smallest size at which the faster tier wins, with
+ * the thresholds already tuned in effect. The results are written to OUTPUT,
+ * or standard output, as a header that can be compiled in with
+ * -DBIGINT_THRESHOLDS_HEADER='"OUTPUT"' or read with bigint_thresholds_load.
+ */
+#include <stdint.h>
+#include <time.h>
+#include "bigint.h"
+
+// The shortest time in seconds that each measurement runs for
+#ifndef TUNE_MIN_TIME
+#define TUNE_MIN_TIME 0.02
+#endif
+
+// The number of measurements of which the fastest is kept
+#ifndef TUNE_REPEATS
+#define TUNE_REPEATS 3
+#endif
+
+// Run one operation at a size, using whichever tiers the thresholds select
+typedef void (*tune_fn)(size_t size);
+
+/* Time an operation
+* The operation is repeated until it runs for TUNE_MIN_TIME, and the best
+* of TUNE_REPEATS such runs is kept.
+* @param fn The operation
+* @param size The operand size
+* @return The seconds taken by one operation
+*/
+double tune_time(tune_fn fn, size_t size) {
+    double best = 0;
+    for (int repeat = 0; repeat < TUNE_REPEATS; repeat++) {
+        size_t calls = 0;
+        clock_t start = clock(), elapsed;
+        do {
+            fn(size);
+            calls++;
+            elapsed = clock() - start;
+        } while ((double)elapsed / CLOCKS_PER_SEC < TUNE_MIN_TIME);
+        double each = (double)elapsed / CLOCKS_PER_SEC / (double)calls;
+        if (repeat == 0 || each < best) {
+            best = each;
+        }
+    }
+    return best;
+}
+
+/* Find the smallest size at which the tier above a threshold is faster
+* The higher tier is assumed to be faster at every size above the
+* crossover, so the search can halve the range.
+* @param name The name of the threshold, for progress messages
+* @param threshold The threshold to tune
+* @param low The smallest size tried
+* @param high The largest size tried
+* @param fn The operation to time
+* @return The crossover, or high if the higher tier never wins
+*/
+size_t tune_crossover(const char *name, size_t *threshold, size_t low, size_t high, tune_fn fn) {
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        *threshold = mid;
+        double above = tune_time(fn, mid);
+        *threshold = SIZE_MAX;
+        double below = tune_time(fn, mid);
+        fprintf(stderr, "%s: %zu: %.3g s below, %.3g s above\n", name, mid, below, above);
+        if (above < below) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    *threshold = low;
+    return low;
+}
+
+// Operands shared by the operations, regenerated whenever the size changes
+int64_t *tune_a, *tune_b, *tune_r;
+uint32_t *tune_words;
+size_t tune_word_count;
+bigint tune_x, tune_y, tune_z;
+bigint *tune_bases, *tune_exponents;
+size_t tune_count;
+bigint_modctx tune_ctx;
+size_t tune_size;
+uint64_t tune_state = 42;
+
+// A random bigint with the given number of decimal digits
+bigint tune_random_digits(size_t digits) {
+    bigint n = {false, malloc(digits * sizeof(int64_t)), digits};
+    for (size_t i = 0; i < digits; i++) {
+        n.digits[i] = (int64_t)(bigint_random_next(&tune_state) % 10);
+    }
+    n.digits[0] = 1 + (int64_t)(bigint_random_next(&tune_state) % 9);
+    return n;
+}
+
+// Free the operands of the previous size
+void tune_release(void) {
+    free(tune_a);
+    free(tune_b);
+    free(tune_r);
+    free(tune_words);
+    tune_a = tune_b = tune_r = NULL;
+    tune_words = NULL;
+    bigint_delete(tune_x);
+    bigint_delete(tune_y);
+    bigint_delete(tune_z);
+    tune_x = bigint_zero();
+    tune_y = bigint_zero();
+    tune_z = bigint_zero();
+    tune_size = 0;
+}
+
+// Multiply two random limb arrays of size limbs
+void tune_limbs_mul(size_t size) {
+    if (size != tune_size) {
+        tune_release();
+        tune_a = malloc(size * sizeof(int64_t));
+        tune_b = malloc(size * sizeof(int64_t));
+        tune_r = malloc(2 * size * sizeof(int64_t));
+        for (size_t i = 0; i < size; i++) {
+            tune_a[i] = (int64_t)(bigint_random_next(&tune_state) % BIGINT_LIMB_BASE);
+            tune_b[i] = (int64_t)(bigint_random_next(&tune_state) % BIGINT_LIMB_BASE);
+        }
+        tune_size = size;
+    }
+    bigint_limbs_mul(tune_a, size, tune_b, size, tune_r);
+}
+
+// Divide a random number of 2 * size digits by one of size digits
+void tune_divmod(size_t size) {
+    if (size != tune_size) {
+        tune_release();
+        tune_x = tune_random_digits(2 * size);
+        tune_y = tune_random_digits(size);
+        tune_size = size;
+    }
+    bigint remainder;
+    bigint quotient = bigint_divmod(tune_x, tune_y, &remainder);
+    bigint_delete(quotient);
+    bigint_delete(remainder);
+}
+
+// Divide exactly to a quotient of size digits by a divisor of size digits
+void tune_divexact(size_t size) {
+    if (size != tune_size) {
+        tune_release();
+        tune_y = tune_random_digits(size);
+        tune_z = tune_random_digits(size);
+        tune_x = bigint_mul(tune_y, tune_z);
+        tune_size = size;
+    }
+    bigint quotient = bigint_divexact(tune_x, tune_y);
+    bigint_delete(quotient);
+}
+
+// Convert a random number of size digits to 32-bit words
+void tune_to_words(size_t size) {
+    if (size != tune_size) {
+        tune_release();
+        tune_x = tune_random_digits(size);
+        tune_size = size;
+    }
+    size_t count;
+    free(bigint_to_words(tune_x, &count));
+}
+
+// Convert the words of a random number of size digits back to a bigint
+void tune_from_words(size_t size) {
+    if (size != tune_size) {
+        tune_release();
+        tune_x = tune_random_digits(size);
+        tune_words = bigint_to_words(tune_x, &tune_word_count);
+        tune_size = size;
+    }
+    bigint n = bigint_from_words(tune_words, tune_word_count, false);
+    bigint_delete(n);
+}
+
+// The bits in the modulus and exponents of the multi-exponentiations
+#define TUNE_MULTI_POW_BITS 256
+
+// Multiply size powers modulo a fixed odd modulus
+void tune_multi_pow(size_t size) {
+    if (size > tune_count) {
+        tune_bases = realloc(tune_bases, size * sizeof(bigint));
+        tune_exponents = realloc(tune_exponents, size * sizeof(bigint));
+        for (size_t i = tune_count; i < size; i++) {
+            tune_bases[i] = bigint_random_bits(TUNE_MULTI_POW_BITS, &tune_state);
+            tune_exponents[i] = bigint_random_bits(TUNE_MULTI_POW_BITS, &tune_state);
+        }
+        tune_count = size;
+    }
+    bigint product = bigint_multi_pow(tune_ctx, tune_bases, tune_exponents, size);
+    bigint_delete(product);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [OUTPUT]\n", argv[0]);
+        return 2;
+    }
+
+    tune_x = bigint_zero();
+    tune_y = bigint_zero();
+    tune_z = bigint_zero();
+    size_t ntt = bigint_thresholds.ntt;
+    bigint_thresholds.ntt = SIZE_MAX;
+    tune_crossover("karatsuba", &bigint_thresholds.karatsuba, 4, 256, tune_limbs_mul);
+    bigint_thresholds.ntt = ntt;
+    tune_crossover("ntt", &bigint_thresholds.ntt, 256, 16384, tune_limbs_mul);
+    tune_crossover("newton_div", &bigint_thresholds.newton_div, 50, 5000, tune_divmod);
+    tune_crossover("divexact_dc", &bigint_thresholds.divexact_dc, 50, 5000, tune_divexact);
+    tune_crossover("to_words_dc", &bigint_thresholds.to_words_dc, 20000, 600000, tune_to_words);
+    tune_crossover("from_words_dc", &bigint_thresholds.from_words_dc, 500, 100000, tune_from_words);
+    tune_release();
+
+    bigint modulus = bigint_random_bits(TUNE_MULTI_POW_BITS, &tune_state);
+    if (modulus.size > 0 && modulus.digits[modulus.size - 1] % 2 == 0) {
+        modulus.digits[modulus.size - 1]++;
+    }
+    tune_ctx = bigint_modctx_new(modulus);
+    tune_crossover("pippenger", &bigint_thresholds.pippenger, 2, 256, tune_multi_pow);
+    for (size_t i = 0; i < tune_count; i++) {
+        bigint_delete(tune_bases[i]);
+        bigint_delete(tune_exponents[i]);
+    }
+    free(tune_bases);
+    free(tune_exponents);
+    bigint_modctx_delete(tune_ctx);
+    bigint_delete(modulus);
+
+    FILE *out = argc == 2 ? fopen(argv[1], "w") : stdout;
+    if (!out || !bigint_thresholds_write(out)) {
+        fprintf(stderr, "tune: cannot write the thresholds\n");
+        return 1;
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}